@@ -0,0 +1,208 @@
+#include "SimulationDriver.h"
+#include "codec/FrameCodec.h"
+#include "core/Server.h"
+#include "data/InMemoryRepositories.h"
+#include "service/RoomService.h"
+#include "session/FrameBufferPool.h"
+#include "session/OutboundQueue.h"
+#include "session/Session.h"
+#include "session/Transport.h"
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace {
+    std::string roomName(size_t room) {
+        return "sim_room_" + std::to_string(room);
+    }
+    // Envelope 只有一个 oneof，消息体的第一个 tag 即 payload 字段号，不必完整解析
+    int payloadFieldOf(const char* body, size_t size) {
+        uint32_t tag = 0;
+        for (size_t i = 0, shift = 0; i < size && shift < 32; ++i, shift += 7) {
+            const auto byte = static_cast<unsigned char>(body[i]);
+            tag |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return static_cast<int>(tag >> 3);
+            }
+        }
+        return 0;
+    }
+}
+
+SimulationDriver::SimulationDriver(SimulationOptions options) : options(std::move(options)) {}
+
+void SimulationDriver::onOutbound(const char* data, size_t size) {
+    bytesOut.fetch_add(size, std::memory_order_relaxed);
+    writesOut.fetch_add(1, std::memory_order_relaxed);
+    size_t offset = 0;
+    while (offset + FrameCodec::header_length <= size) {
+        std::array<char, FrameCodec::header_length> header;
+        std::copy_n(data + offset, header.size(), header.begin());
+        bool compressed = false;
+        const uint32_t length = FrameCodec::readHeader(header, compressed);
+        offset += FrameCodec::header_length;
+        const int field = payloadFieldOf(data + offset, std::min<size_t>(length, size - offset));
+        if (field > 0 && static_cast<size_t>(field) < received.size()) {
+            received[field].fetch_add(1, std::memory_order_relaxed);
+        }
+        offset += length;
+    }
+}
+uint64_t SimulationDriver::receivedCount(int payloadField) const {
+    return received[payloadField].load(std::memory_order_relaxed);
+}
+void SimulationDriver::deliver(VirtualClient& client, const chat::Envelope& envelope) {
+    const std::string frame = FrameCodec::encode(envelope.SerializeAsString());
+    client.transport->deliver(frame.data(), frame.size());
+}
+
+template <typename Build>
+void SimulationDriver::runPhase(const std::string& name, int payloadField, uint64_t expected, size_t first, size_t step, Build build) {
+    PhaseResult result;
+    result.name = name;
+    const uint64_t before = receivedCount(payloadField);
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = first; i < clients.size(); i += step) {
+        for (const chat::Envelope& envelope : build(i)) {
+            deliver(clients[i], envelope);
+            ++result.requests;
+        }
+    }
+    uint64_t last = before;
+    auto lastProgress = std::chrono::steady_clock::now();
+    while (receivedCount(payloadField) - before < expected) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const uint64_t now = receivedCount(payloadField);
+        if (now != last) {
+            last = now;
+            lastProgress = std::chrono::steady_clock::now();
+        } else if (std::chrono::steady_clock::now() - lastProgress > std::chrono::seconds(options.idleTimeoutSeconds)) {
+            std::cerr << "[Simulate] Phase '" << name << "' stalled at " << now - before << "/" << expected << " responses" << std::endl;
+            break;
+        }
+    }
+    result.responses = receivedCount(payloadField) - before;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[Simulate] " << name << ": " << result.requests << " requests in " << result.seconds << " s" << std::endl;
+    phases.push_back(std::move(result));
+}
+
+int SimulationDriver::run() {
+    asio::io_context ioc;
+    auto work_guard = asio::make_work_guard(ioc);
+    Server server(ioc, std::make_unique<InMemoryUserRepository>(), std::make_unique<InMemoryRoomRepository>(),
+        std::make_unique<InMemoryMessageRepository>());
+    if (options.presenceWindowMs > 0) {
+        PresenceConfig presence;
+        presence.window = std::chrono::milliseconds(options.presenceWindowMs);
+        server.enablePresenceBatching(presence);
+    }
+    if (options.flushWindowUs > 0) {
+        OutboundLimits limits = OutboundQueue::getLimits();
+        limits.flushWindowUs = options.flushWindowUs;
+        OutboundQueue::configure(limits);
+    }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.threads; ++i) {
+        threads.emplace_back([&ioc]() { ioc.run(); });
+    }
+
+    const size_t sessionCount = static_cast<size_t>(options.sessions);
+    const size_t roomSize = static_cast<size_t>(std::max(1, options.roomSize));
+    const size_t roomCount = (sessionCount + roomSize - 1) / roomSize;
+    const auto createStart = std::chrono::steady_clock::now();
+    clients.resize(sessionCount);
+    for (auto& client : clients) {
+        auto transport = std::make_unique<LoopbackTransport>(ioc.get_executor(),
+            [this](const char* data, size_t size) { onOutbound(data, size); });
+        client.transport = transport.get();
+        client.session = std::make_shared<Session>(std::move(transport), server);
+        client.session->start();
+    }
+    phases.push_back({ "create_sessions", sessionCount, 0,
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - createStart).count() });
+
+    auto username = [](size_t i) { return "sim_" + std::to_string(i); };
+    runPhase("register", chat::Envelope::kRegistrationResponseFieldNumber, sessionCount, 0, 1, [&](size_t i) {
+        chat::Envelope envelope;
+        envelope.mutable_registration_request()->set_username(username(i));
+        envelope.mutable_registration_request()->set_password("password");
+        return std::vector<chat::Envelope>{ envelope };
+    });
+    runPhase("login", chat::Envelope::kLoginResponseFieldNumber, sessionCount, 0, 1, [&](size_t i) {
+        chat::Envelope envelope;
+        envelope.mutable_login_request()->set_username(username(i));
+        envelope.mutable_login_request()->set_password("password");
+        return std::vector<chat::Envelope>{ envelope };
+    });
+    // 每个房间的第一个会话建房，其余成员随后加入
+    runPhase("create_room", chat::Envelope::kRoomOperationResponseFieldNumber, roomCount, 0, roomSize, [&](size_t i) {
+        chat::Envelope envelope;
+        envelope.mutable_room_operation_request()->set_operation(chat::RoomOperation::CREATE);
+        envelope.mutable_room_operation_request()->set_room_name(roomName(i / roomSize));
+        return std::vector<chat::Envelope>{ envelope };
+    });
+    runPhase("join_room", chat::Envelope::kRoomOperationResponseFieldNumber, sessionCount - roomCount, 0, 1, [&](size_t i) {
+        if (i % roomSize == 0) {
+            return std::vector<chat::Envelope>{};
+        }
+        chat::Envelope envelope;
+        envelope.mutable_room_operation_request()->set_operation(chat::RoomOperation::JOIN);
+        envelope.mutable_room_operation_request()->set_room_name(roomName(i / roomSize));
+        envelope.mutable_room_operation_request()->set_want_snapshot(options.joinSnapshot);
+        return std::vector<chat::Envelope>{ envelope };
+    });
+    // 广播包含发送者本人，每条消息送达所在房间的全部成员
+    uint64_t expectedBroadcasts = 0;
+    for (size_t room = 0; room < roomCount; ++room) {
+        const uint64_t members = std::min(roomSize, sessionCount - room * roomSize);
+        expectedBroadcasts += members * members * static_cast<uint64_t>(options.messagesPerSession);
+    }
+    const std::string content(options.messageBytes, 'x');
+    runPhase("public_message", chat::Envelope::kMessageBroadcastFieldNumber, expectedBroadcasts, 0, 1, [&](size_t) {
+        std::vector<chat::Envelope> envelopes(options.messagesPerSession);
+        for (auto& envelope : envelopes) {
+            envelope.mutable_public_message()->set_content(content);
+        }
+        return envelopes;
+    });
+
+    for (auto& client : clients) {
+        client.transport->shutdown();
+    }
+    server.stop();
+    work_guard.reset();
+    for (auto& t : threads) {
+        t.join();
+    }
+    clients.clear();
+    printSummary();
+    return 0;
+}
+
+void SimulationDriver::printSummary() const {
+    std::cout << "\n--- Simulation Summary ---\n"
+              << "Sessions: " << options.sessions << ", threads: " << options.threads
+              << ", room size: " << options.roomSize << ", messages/session: " << options.messagesPerSession << "\n";
+    std::cout << std::left << std::setw(18) << "phase" << std::right << std::setw(12) << "requests"
+              << std::setw(14) << "responses" << std::setw(12) << "seconds" << std::setw(14) << "req/s" << "\n";
+    for (const auto& phase : phases) {
+        std::cout << std::left << std::setw(18) << phase.name << std::right << std::setw(12) << phase.requests
+                  << std::setw(14) << phase.responses << std::setw(12) << std::fixed << std::setprecision(3) << phase.seconds
+                  << std::setw(14) << std::setprecision(0) << (phase.seconds > 0 ? phase.requests / phase.seconds : 0) << "\n";
+    }
+    std::cout << "Server frames by type:";
+    const auto* descriptor = chat::Envelope::descriptor();
+    for (size_t field = 0; field < received.size(); ++field) {
+        const uint64_t count = received[field].load(std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        const auto* fieldDescriptor = descriptor->FindFieldByNumber(static_cast<int>(field));
+        std::cout << " " << (fieldDescriptor ? fieldDescriptor->name() : std::to_string(field)) << "=" << count;
+    }
+    std::cout << "\nServer bytes out: " << bytesOut.load(std::memory_order_relaxed)
+              << ", writes: " << writesOut.load(std::memory_order_relaxed) << "\n"
+              << OutboundQueue::describeStats() << "\n"
+              << FrameBufferPool::describeStats() << std::endl;
+}
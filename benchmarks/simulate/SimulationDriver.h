@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "chat.pb.h"
+
+class Session;
+class LoopbackTransport;
+
+struct SimulationOptions {
+    int sessions = 100000;
+    int threads = 4;
+    int roomSize = 100;          // 每个房间的成员数，最后一个房间可能不满
+    int messagesPerSession = 10;
+    size_t messageBytes = 64;
+    int presenceWindowMs = 0;    // 大于 0 时按该窗口合并进出通知
+    bool joinSnapshot = false;   // 加入房间时请求快照
+    int flushWindowUs = 0;       // 大于 0 时启用出站合并窗口
+    int idleTimeoutSeconds = 5;  // 某阶段的响应数在这段时间内不再增长则视为结束
+};
+
+// 进程内模拟：大量通过 LoopbackTransport 连接的虚拟会话，请求经完整的 Session 读路径进入
+// Server::onMessage / dispatchMessage，服务层与加锁开销可以脱离网络单独测量
+class SimulationDriver {
+public:
+    explicit SimulationDriver(SimulationOptions options);
+    int run();
+private:
+    struct VirtualClient {
+        std::shared_ptr<Session> session;
+        LoopbackTransport* transport = nullptr;
+    };
+    struct PhaseResult {
+        std::string name;
+        uint64_t requests = 0;
+        uint64_t responses = 0;
+        double seconds = 0;
+    };
+    void deliver(VirtualClient& client, const chat::Envelope& envelope);
+    // 逐个会话发出 build(i) 生成的请求，等待 payloadField 类型的响应达到 expected
+    template <typename Build>
+    void runPhase(const std::string& name, int payloadField, uint64_t expected, size_t first, size_t step, Build build);
+    void onOutbound(const char* data, size_t size);
+    uint64_t receivedCount(int payloadField) const;
+    void printSummary() const;
+
+    SimulationOptions options;
+    std::vector<VirtualClient> clients;
+    std::vector<PhaseResult> phases;
+    // 按 Envelope payload 字段号统计服务器发出的帧
+    std::array<std::atomic<uint64_t>, 128> received{};
+    std::atomic<uint64_t> bytesOut{0};
+    std::atomic<uint64_t> writesOut{0};
+};
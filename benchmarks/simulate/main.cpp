@@ -0,0 +1,34 @@
+#include "SimulationDriver.h"
+#include "util/Logger.h"
+#include <iostream>
+#include <thread>
+
+int main(int argc, char* argv[]) {
+    SimulationOptions options;
+    options.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--sessions") {
+            options.sessions = std::stoi(argv[i + 1]);
+        } else if (flag == "--threads") {
+            options.threads = std::stoi(argv[i + 1]);
+        } else if (flag == "--room-size") {
+            options.roomSize = std::stoi(argv[i + 1]);
+        } else if (flag == "--messages") {
+            options.messagesPerSession = std::stoi(argv[i + 1]);
+        } else if (flag == "--message-bytes") {
+            options.messageBytes = static_cast<size_t>(std::stoul(argv[i + 1]));
+        } else if (flag == "--join-snapshot") {
+            options.joinSnapshot = std::stoi(argv[i + 1]) != 0;
+        } else if (flag == "--flush-window-us") {
+            options.flushWindowUs = std::stoi(argv[i + 1]);
+        } else if (flag == "--presence-window-ms") {
+            options.presenceWindowMs = std::stoi(argv[i + 1]);
+        } else {
+            std::cerr << "Usage: simulate [--sessions n] [--threads n] [--room-size n] [--messages n] [--message-bytes n] [--presence-window-ms n] [--flush-window-us n] [--join-snapshot 0|1]" << std::endl;
+            return 1;
+        }
+    }
+    Logger::setLevel(LogLevel::Warn);
+    return SimulationDriver(options).run();
+}
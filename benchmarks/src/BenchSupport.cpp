@@ -0,0 +1,106 @@
+#include "BenchSupport.h"
+#include "data/InMemoryRepositories.h"
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    using google::protobuf::FieldDescriptor;
+
+    // 按线程计数，不给多线程基准引入共享写
+    thread_local uint64_t heapAllocations = 0;
+
+    constexpr int repeated_sample_count = 20; // 例如历史消息响应里的消息条数
+
+    void fillSample(google::protobuf::Message* message, int depth) {
+        const auto* descriptor = message->GetDescriptor();
+        const auto* reflection = message->GetReflection();
+        for (int i = 0; i < descriptor->field_count(); ++i) {
+            const FieldDescriptor* field = descriptor->field(i);
+            // oneof 只填第一个成员
+            if (field->real_containing_oneof() && reflection->HasOneof(*message, field->real_containing_oneof())) {
+                continue;
+            }
+            const int count = field->is_repeated() ? repeated_sample_count : 1;
+            for (int n = 0; n < count; ++n) {
+                switch (field->cpp_type()) {
+                    case FieldDescriptor::CPPTYPE_STRING: {
+                        const std::string value = "sample " + field->name() + " for benchmarking";
+                        field->is_repeated() ? reflection->AddString(message, field, value) : reflection->SetString(message, field, value);
+                        break;
+                    }
+                    case FieldDescriptor::CPPTYPE_INT32:
+                        field->is_repeated() ? reflection->AddInt32(message, field, 42) : reflection->SetInt32(message, field, 42);
+                        break;
+                    case FieldDescriptor::CPPTYPE_INT64:
+                        field->is_repeated() ? reflection->AddInt64(message, field, 1700000000000LL) : reflection->SetInt64(message, field, 1700000000000LL);
+                        break;
+                    case FieldDescriptor::CPPTYPE_UINT32:
+                        field->is_repeated() ? reflection->AddUInt32(message, field, 42) : reflection->SetUInt32(message, field, 42);
+                        break;
+                    case FieldDescriptor::CPPTYPE_UINT64:
+                        field->is_repeated() ? reflection->AddUInt64(message, field, 42) : reflection->SetUInt64(message, field, 42);
+                        break;
+                    case FieldDescriptor::CPPTYPE_BOOL:
+                        field->is_repeated() ? reflection->AddBool(message, field, true) : reflection->SetBool(message, field, true);
+                        break;
+                    case FieldDescriptor::CPPTYPE_ENUM: {
+                        const auto* value = field->enum_type()->value(field->enum_type()->value_count() - 1);
+                        field->is_repeated() ? reflection->AddEnum(message, field, value) : reflection->SetEnum(message, field, value);
+                        break;
+                    }
+                    case FieldDescriptor::CPPTYPE_MESSAGE:
+                        if (depth < 3) {
+                            fillSample(field->is_repeated() ? reflection->AddMessage(message, field)
+                                : reflection->MutableMessage(message, field), depth + 1);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+}
+
+BenchEnvironment& BenchEnvironment::get() {
+    static BenchEnvironment environment;
+    return environment;
+}
+BenchEnvironment::BenchEnvironment()
+    : server(std::make_unique<Server>(ioc, std::make_unique<InMemoryUserRepository>(),
+        std::make_unique<InMemoryRoomRepository>(), std::make_unique<InMemoryMessageRepository>())) {}
+
+std::shared_ptr<Session> BenchEnvironment::makeSession(long long userId) {
+    auto session = Session::create(asio::ip::tcp::socket(ioc), *server);
+    session->setAuthenticated(userId, "user_" + std::to_string(userId));
+    return session;
+}
+chat::Envelope makeSampleEnvelope(int payloadFieldNumber) {
+    chat::Envelope envelope;
+    const auto* field = chat::Envelope::descriptor()->FindFieldByNumber(payloadFieldNumber);
+    if (field && field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+        fillSample(envelope.GetReflection()->MutableMessage(&envelope, field), 0);
+    }
+    return envelope;
+}
+
+uint64_t heapAllocationCount() {
+    return heapAllocations;
+}
+
+// 替换全局分配函数以统计分配次数；数组与 nothrow 版本默认转发到这里
+void* operator new(std::size_t size) {
+    ++heapAllocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
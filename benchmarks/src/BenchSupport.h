@@ -0,0 +1,32 @@
+#pragma once
+
+#include <asio.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "chat.pb.h"
+#include "core/Server.h"
+#include "session/Session.h"
+
+// 基准测试共用的进程内环境：使用内存仓储、不监听端口的 Server，
+// 以及不连接任何对端的会话（socket 未打开，io_context 不运行）
+class BenchEnvironment {
+public:
+    static BenchEnvironment& get();
+
+    asio::io_context& getIoContext() { return ioc; }
+    Server& getServer() { return *server; }
+    // 已认证的会话，用户 ID 为 userId，用户名为 "user_<userId>"
+    std::shared_ptr<Session> makeSession(long long userId);
+private:
+    BenchEnvironment();
+    asio::io_context ioc;
+    std::unique_ptr<Server> server;
+};
+
+// 为 Envelope 的某个 payload 字段生成一份字段都被填充的样本
+chat::Envelope makeSampleEnvelope(int payloadFieldNumber);
+
+// 当前线程累计调用全局 operator new 的次数，基准前后相减得到被测代码的堆分配次数
+uint64_t heapAllocationCount();
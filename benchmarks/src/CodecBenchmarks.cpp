@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+#include "BenchSupport.h"
+#include "codec/FrameCodec.h"
+#include "codec/ZstdCompressor.h"
+#include "session/OutboundFrame.h"
+#include <google/protobuf/descriptor.h>
+
+namespace {
+    chat::Envelope sampleBroadcast() {
+        return makeSampleEnvelope(chat::Envelope::kMessageBroadcastFieldNumber);
+    }
+}
+
+// 每种 payload 各注册一组序列化/解析基准，名字中带字段名
+void registerEnvelopeBenchmarks() {
+    const auto* descriptor = chat::Envelope::descriptor();
+    for (int i = 0; i < descriptor->field_count(); ++i) {
+        const auto* field = descriptor->field(i);
+        if (!field->real_containing_oneof()) {
+            continue;
+        }
+        const int number = field->number();
+        // 旧版 Google Benchmark 只接受 const char*，名字会被复制
+        const std::string serializeName = "Envelope/Serialize/" + field->name();
+        benchmark::RegisterBenchmark(serializeName.c_str(), [number](benchmark::State& state) {
+            const chat::Envelope envelope = makeSampleEnvelope(number);
+            std::string out;
+            for (auto _ : state) {
+                out.clear();
+                envelope.SerializeToString(&out);
+                benchmark::DoNotOptimize(out.data());
+            }
+            state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(out.size()));
+        });
+        const std::string parseName = "Envelope/Parse/" + field->name();
+        benchmark::RegisterBenchmark(parseName.c_str(), [number](benchmark::State& state) {
+            const std::string wire = makeSampleEnvelope(number).SerializeAsString();
+            chat::Envelope envelope;
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(envelope.ParseFromString(wire));
+            }
+            state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(wire.size()));
+        });
+    }
+}
+
+// 与 Session::send 相同的路径：序列化 + 加帧头，得到待写出的共享缓冲
+static void BM_SessionFrameEncode(benchmark::State& state) {
+    const chat::Envelope envelope = sampleBroadcast();
+    const uint64_t allocationsBefore = heapAllocationCount();
+    for (auto _ : state) {
+        auto frame = OutboundFrame::encode(envelope, false);
+        benchmark::DoNotOptimize(frame->wire(false));
+    }
+    state.counters["allocs_per_frame"] = benchmark::Counter(
+        static_cast<double>(heapAllocationCount() - allocationsBefore), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_SessionFrameEncode);
+
+static void BM_FrameEncodeZstd(benchmark::State& state) {
+    const std::string body = sampleBroadcast().SerializeAsString();
+    const ZstdCompressor compressor;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(FrameCodec::encode(body, &compressor, 0));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(body.size()));
+}
+BENCHMARK(BM_FrameEncodeZstd);
+
+static void BM_FrameDecode(benchmark::State& state) {
+    const std::string frame = FrameCodec::encode(sampleBroadcast().SerializeAsString());
+    std::array<char, FrameCodec::header_length> header;
+    std::copy_n(frame.data(), header.size(), header.begin());
+    for (auto _ : state) {
+        bool compressed = false;
+        const uint32_t length = FrameCodec::readHeader(header, compressed);
+        chat::Envelope envelope;
+        benchmark::DoNotOptimize(envelope.ParseFromArray(frame.data() + FrameCodec::header_length, static_cast<int>(length)));
+    }
+}
+BENCHMARK(BM_FrameDecode);
@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+#include "BenchSupport.h"
+#include "core/SessionManager.h"
+#include "data/InMemoryRepositories.h"
+#include "service/RoomService.h"
+#include "util/Crypto.h"
+#include <mutex>
+#include <random>
+
+// 绕过 JOIN 流程直接填充房间，否则逐个加入会产生 O(n^2) 的入房广播
+struct RoomServiceBenchAccess {
+    static RoomRef fill(RoomService& service, const std::string& roomName, const std::vector<std::shared_ptr<Session>>& sessions) {
+        LockGuard<ServerMutex> lock(service.mutex);
+        Room room;
+        room.setId(1);
+        room.setName(roomName);
+        room.setCreatorId(sessions.empty() ? 0 : sessions.front()->getUserId());
+        const uint32_t slot = service.openRoomLocked(room);
+        for (const auto& session : sessions) {
+            service.addMemberLocked(slot, session->getUserId(), session);
+        }
+        return service.refLocked(slot);
+    }
+};
+
+namespace {
+    constexpr int lookup_population = 10000;
+
+    struct LookupFixture {
+        ServerMutex mtx{"bench_lookup"};
+        SessionManager manager{mtx};
+        LookupFixture() {
+            for (long long id = 1; id <= lookup_population; ++id) {
+                auto session = BenchEnvironment::get().makeSession(id);
+                manager.registerAuthenticatedSession(session, id, session->getUsername());
+            }
+        }
+    };
+    LookupFixture& lookupFixture() {
+        static LookupFixture fixture;
+        return fixture;
+    }
+}
+
+static void BM_SessionManagerFindByUserId(benchmark::State& state) {
+    SessionManager& manager = lookupFixture().manager;
+    std::mt19937 rng(state.thread_index());
+    std::uniform_int_distribution<long long> dist(1, lookup_population);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(manager.findByUserId(dist(rng)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SessionManagerFindByUserId)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_SessionManagerFindByUsername(benchmark::State& state) {
+    SessionManager& manager = lookupFixture().manager;
+    std::mt19937 rng(state.thread_index());
+    std::uniform_int_distribution<long long> dist(1, lookup_population);
+    std::vector<std::string> names;
+    for (int i = 0; i < 1024; ++i) {
+        names.push_back("user_" + std::to_string(dist(rng)));
+    }
+    size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(manager.findByUsername(names[next++ & 1023]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SessionManagerFindByUsername)->ThreadRange(1, 16)->UseRealTime();
+
+// 广播前在锁内收集接收者的开销，房间人数 10 ~ 100k
+static void BM_BroadcastCollectRecipients(benchmark::State& state) {
+    const auto members = static_cast<long long>(state.range(0));
+    ServerMutex mtx{"bench_room"};
+    InMemoryUserRepository users;
+    InMemoryRoomRepository rooms;
+    InMemoryMessageRepository messages;
+    SessionManager manager(mtx);
+    RoomService service(mtx, &rooms, &users, &messages, &manager);
+    std::vector<std::shared_ptr<Session>> sessions;
+    sessions.reserve(members);
+    for (long long id = 1; id <= members; ++id) {
+        sessions.push_back(BenchEnvironment::get().makeSession(id));
+    }
+    const RoomRef room = RoomServiceBenchAccess::fill(service, "bench_room", sessions);
+    for (auto _ : state) {
+        bool anyCompressed = false;
+        benchmark::DoNotOptimize(service.collectRecipients(room, 1, anyCompressed));
+    }
+    state.SetItemsProcessed(state.iterations() * (members - 1));
+}
+BENCHMARK(BM_BroadcastCollectRecipients)->RangeMultiplier(10)->Range(10, 100000);
+
+static void BM_CryptoHashPassword(benchmark::State& state) {
+    const std::string salt = Crypto::generateSalt();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Crypto::hashPassword("correct horse battery staple", salt));
+    }
+}
+BENCHMARK(BM_CryptoHashPassword);
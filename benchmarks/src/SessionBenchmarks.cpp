@@ -0,0 +1,181 @@
+#include <benchmark/benchmark.h>
+#include "BenchSupport.h"
+#include "core/SessionManager.h"
+#include "session/OutboundFrame.h"
+#include "session/OutboundMailbox.h"
+#include "session/Transport.h"
+#include <thread>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// 出站帧交给会话 strand 的两种方式：每帧一次 asio::post（原 Session::send 的做法），
+// 以及无锁邮箱 + 由空变非空时才投递一次 drain。消费端只计数，测量的是交接本身的开销
+namespace {
+    constexpr int handoff_io_threads = 4;
+
+    struct HandoffFixture {
+        asio::io_context ioc;
+        asio::executor_work_guard<asio::io_context::executor_type> guard = asio::make_work_guard(ioc);
+        std::vector<std::thread> threads;
+        std::atomic<uint64_t> produced{0};
+        std::atomic<uint64_t> consumed{0};
+        HandoffFixture() {
+            for (int i = 0; i < handoff_io_threads; ++i) {
+                threads.emplace_back([this]() { ioc.run(); });
+            }
+        }
+        ~HandoffFixture() {
+            guard.reset();
+            ioc.stop();
+            for (auto& t : threads) {
+                t.join();
+            }
+        }
+        // 等待已发出的帧全部被消费，再进入下一轮
+        void waitDrained() {
+            const uint64_t target = produced.load(std::memory_order_acquire);
+            while (consumed.load(std::memory_order_acquire) < target) {
+                std::this_thread::yield();
+            }
+        }
+    };
+    HandoffFixture& handoffFixture() {
+        static HandoffFixture fixture;
+        return fixture;
+    }
+
+    struct PostedReceiver {
+        SessionStrand strand;
+        explicit PostedReceiver(asio::io_context& ioc) : strand(asio::make_strand(ioc.get_executor())) {}
+        void send(FrameBuffer data, FramePriority priority, std::atomic<uint64_t>& consumed) {
+            asio::post(strand, [data = std::move(data), priority, &consumed]() {
+                benchmark::DoNotOptimize(priority);
+                consumed.fetch_add(1, std::memory_order_release);
+            });
+        }
+    };
+
+    struct MailboxReceiver {
+        SessionStrand strand;
+        OutboundMailbox mailbox;
+        explicit MailboxReceiver(asio::io_context& ioc) : strand(asio::make_strand(ioc.get_executor())) {}
+        void send(FrameBuffer data, FramePriority priority, std::atomic<uint64_t>& consumed) {
+            if (mailbox.push(std::move(data), priority)) {
+                asio::post(strand, [this, &consumed]() { drain(consumed); });
+            }
+        }
+        void drain(std::atomic<uint64_t>& consumed) {
+            size_t drained = 0;
+            while (auto node = mailbox.pop()) {
+                benchmark::DoNotOptimize(node->priority);
+                ++drained;
+            }
+            if (mailbox.release(drained)) {
+                asio::post(strand, [this, &consumed]() { drain(consumed); });
+            }
+            // 计数放在最后：计满后夹具可能立即销毁接收者
+            consumed.fetch_add(drained, std::memory_order_release);
+        }
+    };
+
+    // 每轮把 range(1) 条消息依次扇出给 range(0) 个接收者（繁忙房间里一轮广播的形状），
+    // 多个生产者线程同时扇出到同一批接收者
+    template <typename Receiver>
+    void runFanout(benchmark::State& state) {
+        HandoffFixture& fixture = handoffFixture();
+        static std::vector<std::unique_ptr<Receiver>> receivers;
+        const size_t recipients = static_cast<size_t>(state.range(0));
+        const int messages = static_cast<int>(state.range(1));
+        if (state.thread_index() == 0) {
+            receivers.clear();
+            for (size_t i = 0; i < recipients; ++i) {
+                receivers.push_back(std::make_unique<Receiver>(fixture.ioc));
+            }
+        }
+        const FrameBuffer frame = FrameBufferPool::acquire(96);
+        // 只统计生产者线程上的堆分配，即交接本身每帧的分配次数
+        const uint64_t allocationsBefore = heapAllocationCount();
+        for (auto _ : state) {
+            fixture.produced.fetch_add(recipients * messages, std::memory_order_release);
+            for (int m = 0; m < messages; ++m) {
+                for (auto& receiver : receivers) {
+                    receiver->send(frame, FramePriority::Normal, fixture.consumed);
+                }
+            }
+            fixture.waitDrained();
+        }
+        state.counters["allocs_per_frame"] = benchmark::Counter(
+            static_cast<double>(heapAllocationCount() - allocationsBefore) / (static_cast<double>(recipients) * messages),
+            benchmark::Counter::kAvgIterations);
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(recipients) * messages);
+    }
+}
+
+static void BM_OutboundHandoffPostPerFrame(benchmark::State& state) {
+    runFanout<PostedReceiver>(state);
+}
+BENCHMARK(BM_OutboundHandoffPostPerFrame)->ArgsProduct({ { 1000, 10000 }, { 1, 16 } })->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_OutboundHandoffMailbox(benchmark::State& state) {
+    runFanout<MailboxReceiver>(state);
+}
+BENCHMARK(BM_OutboundHandoffMailbox)->ArgsProduct({ { 1000, 10000 }, { 1, 16 } })->ThreadRange(1, 8)->UseRealTime();
+
+// 一条广播帧在服务端的完整生命周期：编码一次，交给 range(0) 个会话的出站队列，
+// 每个队列做一次聚集写并完成写出后释放帧缓冲。报告每条广播的堆分配次数，稳定后应与接收者数无关
+static void BM_BroadcastFrameLifecycle(benchmark::State& state) {
+    const chat::Envelope envelope = makeSampleEnvelope(chat::Envelope::kMessageBroadcastFieldNumber);
+    std::vector<OutboundQueue> queues(static_cast<size_t>(state.range(0)));
+    std::vector<asio::const_buffer> buffers;
+    const uint64_t allocationsBefore = heapAllocationCount();
+    for (auto _ : state) {
+        auto frame = OutboundFrame::encode(envelope, false);
+        for (auto& queue : queues) {
+            queue.push(frame->wire(false), frame->getPriority());
+        }
+        frame.reset();
+        for (auto& queue : queues) {
+            buffers.clear();
+            queue.beginWrite(64, 64 * 1024, [&buffers](const auto& data) {
+                buffers.push_back(asio::buffer(data.data(), data.size()));
+            });
+            benchmark::DoNotOptimize(buffers.data());
+            queue.completeWrite();
+        }
+    }
+    state.counters["allocs_per_broadcast"] = benchmark::Counter(
+        static_cast<double>(heapAllocationCount() - allocationsBefore), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BroadcastFrameLifecycle)->Arg(1)->Arg(16);
+
+// 空闲的已认证会话占用的堆内存：创建 range(0) 个会话并登记到 SessionManager，
+// 用 glibc 的 mallinfo2 统计前后差值。range(1) 为 strand 池大小，0 表示每个会话独占一个 strand。
+// 会话未 start()，挂起的读操作归 asio 所有，不计入
+static void BM_IdleSessionMemory(benchmark::State& state) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    BenchEnvironment& env = BenchEnvironment::get();
+    const size_t count = static_cast<size_t>(state.range(0));
+    env.getServer().setStrandPoolSize(static_cast<size_t>(state.range(1)));
+    for (auto _ : state) {
+        ServerMutex mtx{"bench_idle_sessions"};
+        SessionManager manager{mtx};
+        std::vector<std::shared_ptr<Session>> sessions;
+        sessions.reserve(count);
+        const size_t before = mallinfo2().uordblks;
+        for (size_t i = 1; i <= count; ++i) {
+            auto session = Session::create(asio::ip::tcp::socket(env.getIoContext()), env.getServer());
+            manager.registerAuthenticatedSession(session, static_cast<long long>(i), "user_" + std::to_string(i));
+            sessions.push_back(std::move(session));
+        }
+        const size_t after = mallinfo2().uordblks;
+        state.counters["bytes_per_session"] = static_cast<double>(after - before) / static_cast<double>(count);
+        state.counters["sizeof_session"] = static_cast<double>(sizeof(Session));
+    }
+    env.getServer().setStrandPoolSize(0);
+#else
+    state.SkipWithError("heap usage is measured with glibc mallinfo2");
+#endif
+}
+BENCHMARK(BM_IdleSessionMemory)->Args({ 100000, 0 })->Args({ 100000, 1024 })->Iterations(1)->Unit(benchmark::kMillisecond);
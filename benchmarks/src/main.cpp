@@ -0,0 +1,17 @@
+#include <benchmark/benchmark.h>
+#include "util/Logger.h"
+
+void registerEnvelopeBenchmarks();
+
+int main(int argc, char** argv) {
+    // Logger 不启动，日志只会写进环形缓冲；调高级别避免它影响被测路径
+    Logger::setLevel(LogLevel::Error);
+    registerEnvelopeBenchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "client.h"
+#include "codec/FrameCodec.h"
 #include <iostream>
 #include <google/protobuf/util/time_util.h>
 
@@ -50,6 +51,12 @@ void Client::connect(const std::string& host, unsigned short port, std::function
             if (!ec) {
                 std::cout << "[System] Successfully initiated connection to "
                     << socket.remote_endpoint() << std::endl;
+                if (compressor) {
+                    chat::Envelope hello;
+                    hello.mutable_compression_hello()->add_codecs("zstd");
+                    hello.mutable_compression_hello()->set_dictionary_id(compressor->getDictionaryId());
+                    send(hello);
+                }
                 do_read_header();
             }
             else {
@@ -58,6 +65,19 @@ void Client::connect(const std::string& host, unsigned short port, std::function
         });
 }
 
+void Client::enableCompression(std::shared_ptr<const ZstdCompressor> zstd) {
+    compressor = std::move(zstd);
+}
+Client::TrafficStats Client::getTrafficStats() const {
+    TrafficStats stats;
+    stats.frames_received = frames_received.load(std::memory_order_relaxed);
+    stats.wire_bytes_received = wire_bytes_received.load(std::memory_order_relaxed);
+    stats.decoded_bytes_received = decoded_bytes_received.load(std::memory_order_relaxed);
+    stats.decompress_ns = decompress_ns.load(std::memory_order_relaxed);
+    stats.wire_bytes_sent = wire_bytes_sent.load(std::memory_order_relaxed);
+    return stats;
+}
+
 void Client::close() {
     asio::post(io_context, [this]() { socket.close(); work_guard.reset(); });
 }
@@ -67,7 +87,7 @@ void Client::do_read_header(){
     asio::async_read(socket,asio::buffer(read_header,header),
         [this,self](const asio::error_code& ec,size_t bytes_transferred){
             if(!ec){
-                    const uint32_t body_length=ntohl(*reinterpret_cast<uint32_t*>(read_header.data()));
+                    const uint32_t body_length=FrameCodec::readHeader(read_header,read_compressed);
                     if(body_length>0 && body_length<max_body_length)do_read_body(body_length);
                     else{
                         std::cerr << "Invalid body length received: " << body_length << std::endl;
@@ -98,9 +118,23 @@ void Client::do_read_body(const uint32_t body_length){
         [this,self](const asio::error_code& ec,size_t bytes_transferred){
             if(!ec){
                 chat::Envelope envelope;
-                if(envelope.ParseFromArray(read_body.data(),read_body.size())){
+                bool parsed=false;
+                frames_received.fetch_add(1,std::memory_order_relaxed);
+                wire_bytes_received.fetch_add(FrameCodec::header_length+read_body.size(),std::memory_order_relaxed);
+                if(read_compressed){
+                    std::string decompressed;
+                    auto start=std::chrono::steady_clock::now();
+                    parsed=FrameCodec::decode(read_body.data(),read_body.size(),true,compressor.get(),max_body_length,decompressed)
+                        && envelope.ParseFromString(decompressed);
+                    decompress_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count(),std::memory_order_relaxed);
+                    decoded_bytes_received.fetch_add(decompressed.size(),std::memory_order_relaxed);
+                }else{
+                    parsed=envelope.ParseFromArray(read_body.data(),read_body.size());
+                    decoded_bytes_received.fetch_add(read_body.size(),std::memory_order_relaxed);
+                }
+                if(parsed){
                     handle_server_message(envelope); // 调用消息处理器
-                    do_read_header();
+                    if(!reading_paused.load(std::memory_order_relaxed))do_read_header();
                 }else{
                     std::cerr<<"Failed to parse message body."<<std::endl;
                     handle_error("Failed to parse", asio::error_code());
@@ -114,11 +148,10 @@ void Client::do_read_body(const uint32_t body_length){
 void Client::send(const chat::Envelope& envelope){
     std::string body_data;
     envelope.SerializeToString(&body_data);
-    uint32_t body_length=htonl(body_data.size());
-    std::string write_buf;
-    write_buf.reserve(body_data.size()+sizeof(body_length));
-    write_buf.append(reinterpret_cast<const char*>(&body_length),sizeof(body_length));
-    write_buf.append(body_data);
+    std::string write_buf=isCompressionActive()
+        ? FrameCodec::encode(body_data,compressor.get(),compression_min_size.load(std::memory_order_relaxed))
+        : FrameCodec::encode(body_data);
+    wire_bytes_sent.fetch_add(write_buf.size(),std::memory_order_relaxed);
     auto self=shared_from_this();
     asio::post(socket.get_executor(),
         [this,self,buffer=std::move(write_buf)](){
@@ -148,6 +181,7 @@ void Client::handle_server_message(const Envelope& envelope) {
     switch (envelope.payload_case()) {
         case Envelope::kMessageBroadcast: {
             const auto& msg = envelope.message_broadcast();
+            noteSeq(msg);
             std::string time_str = google::protobuf::util::TimeUtil::ToString(msg.timestamp());
                 std::cout << "[" << msg.room_name() << " | " << msg.from_username() << " at " << time_str << "]: " 
                           << msg.content() << std::endl;
@@ -182,15 +216,31 @@ void Client::handle_server_message(const Envelope& envelope) {
             const auto& resp = envelope.room_operation_response();
             if (resp.success() && (resp.operation() == chat::RoomOperation::JOIN)) {
                 setCurrentRoom(resp.room_name());
-				chat::Envelope historyReq;
-				historyReq.mutable_history_message_request()->set_room_name(resp.room_name());
-				historyReq.mutable_history_message_request()->set_limit(20);
-                send(historyReq);
+                chat::RoomSnapshot snapshot;
+                if (!resp.snapshot().empty() && snapshot.ParseFromString(resp.snapshot())) {
+                    std::cout << "[System] " << snapshot.member_count() << " members online:";
+                    for (const auto& member : snapshot.members()) {
+                        std::cout << " " << member.username();
+                    }
+                    std::cout << std::endl << "[System] Recent messages:" << std::endl;
+                    for (const auto& msg : snapshot.recent_messages()) {
+                        noteSeq(msg);
+                        std::string time_str = google::protobuf::util::TimeUtil::ToString(msg.timestamp());
+                        std::cout << "  [" << msg.room_name() << " | " << msg.from_username() << " at " << time_str << "]: "
+                                  << msg.content() << std::endl;
+                    }
+                } else {
+                    // 服务器未返回快照时退回单独的历史请求
+                    chat::Envelope historyReq;
+                    historyReq.mutable_history_message_request()->set_room_name(resp.room_name());
+                    historyReq.mutable_history_message_request()->set_limit(20);
+                    send(historyReq);
+                }
             }
             else if (resp.operation() == chat::RoomOperation::CREATE) {
                 setCurrentRoom(resp.room_name());
             }
-            else if (resp.success() && (resp.operation() == chat::RoomOperation::LEAVE)) {
+            else if (resp.success() && (resp.operation() == chat::RoomOperation::LEAVE) && resp.room_name() == getCurrentRoom()) {
                 setCurrentRoom("");
 			}
             std::cout << "[System] Room operation response: " << resp.message() << std::endl;
@@ -200,17 +250,72 @@ void Client::handle_server_message(const Envelope& envelope) {
             const auto& resp = envelope.history_message_response();
             std::cout << "[System] History messages:" << std::endl;
             for (const auto& msg : resp.messages()) {
+                noteSeq(msg);
                 std::string time_str = google::protobuf::util::TimeUtil::ToString(msg.timestamp());
                 std::cout << "  [" << msg.room_name() << " | " << msg.from_username() << " at " << time_str << "]: " 
                           << msg.content() << std::endl;
             }
             break;
         }
+        case Envelope::kEphemeralSignal: {
+            const auto& signal = envelope.ephemeral_signal();
+            if (signal.kind() == chat::EphemeralKind::TYPING) {
+                std::cout << "[" << signal.room_name() << "] " << signal.from_username() << " is typing..." << std::endl;
+            }
+            break;
+        }
+        case Envelope::kSyncResponse: {
+            const auto& resp = envelope.sync_response();
+            std::cout << "[System] " << resp.messages_size() << " missed messages in " << resp.room_name() << ":" << std::endl;
+            for (const auto& msg : resp.messages()) {
+                noteSeq(msg);
+                std::string time_str = google::protobuf::util::TimeUtil::ToString(msg.timestamp());
+                std::cout << "  [" << msg.room_name() << " | " << msg.from_username() << " at " << time_str << "]: "
+                          << msg.content() << std::endl;
+            }
+            if (!resp.complete() && resp.messages_size() > 0) {
+                chat::Envelope next;
+                next.mutable_sync_request()->set_room_name(resp.room_name());
+                next.mutable_sync_request()->set_since_seq(resp.messages(resp.messages_size() - 1).room_seq());
+                send(next);
+            }
+            break;
+        }
+        case Envelope::kCompressionAccept: {
+            const auto& accept = envelope.compression_accept();
+            compression_min_size.store(accept.min_size(), std::memory_order_relaxed);
+            compression_active.store(compressor && accept.codec() == "zstd", std::memory_order_release);
+            std::cout << "[System] Compression negotiated: " << accept.codec()
+                      << " (dictionary ID: " << accept.dictionary_id() << ")" << std::endl;
+            break;
+        }
+        case Envelope::kPing: {
+            chat::Envelope pong;
+            pong.mutable_pong()->set_timestamp_ms(envelope.ping().timestamp_ms());
+            send(pong);
+            break;
+        }
+        case Envelope::kPong:
+            break;
         case Envelope::kServerNotification: {
             const auto& event = envelope.server_notification();
             std::cout << event.message() << std::endl;
             break;
         }
+        case Envelope::kPresenceDiff: {
+            const auto& diff = envelope.presence_diff();
+            std::cout << "[" << diff.room_name() << "] ";
+            if (!diff.count_only()) {
+                for (const auto& member : diff.joined()) {
+                    std::cout << "+" << member.username() << " ";
+                }
+                for (const auto& member : diff.left()) {
+                    std::cout << "-" << member.username() << " ";
+                }
+            }
+            std::cout << "(" << diff.member_count() << " online)" << std::endl;
+            break;
+        }
         case Envelope::kErrorResponse: {
             const auto& err = envelope.error_response();
             std::cout << "[Error] " << err.error_message() << " (Code: " << err.error_code() << ")" << std::endl;
@@ -221,6 +326,19 @@ void Client::handle_server_message(const Envelope& envelope) {
             break;
     }
 }
+long long Client::getLastSeenSeq(const std::string& roomName) const {
+    std::lock_guard<std::mutex> lock(seq_mutex);
+    auto it = lastSeenSeq.find(roomName);
+    return it != lastSeenSeq.end() ? it->second : 0;
+}
+void Client::noteSeq(const chat::MessageBroadcast& msg) {
+    if (msg.room_seq() == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(seq_mutex);
+    long long& last = lastSeenSeq[msg.room_name()];
+    last = std::max<long long>(last, msg.room_seq());
+}
 void Client::handle_error(const std::string& where, const std::error_code& ec) {
     if (ec == asio::error::eof) {
         std::cout << "[System] Connection closed by server (" << where << ")." << std::endl;
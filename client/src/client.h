@@ -6,8 +6,12 @@
 #include <string>
 #include <deque>
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 #include <asio/executor_work_guard.hpp>
 #include "chat.pb.h"
+#include "codec/ZstdCompressor.h"
 
 using Envelope = chat::Envelope;
 
@@ -20,6 +24,22 @@ public:
     void send(const Envelope& envelope);
     std::string getCurrentRoom() const { return currentRoom; }
     void setCurrentRoom(const std::string& roomName) { currentRoom = roomName; }
+    // 该房间已收到的最大消息序号，用于 SyncRequest
+    long long getLastSeenSeq(const std::string& roomName) const;
+    // 连接前调用，连接建立后会向服务器发起压缩协商
+    void enableCompression(std::shared_ptr<const ZstdCompressor> compressor);
+    bool isCompressionActive() const { return compression_active.load(std::memory_order_acquire); }
+    // 停止从 socket 读取，模拟卡住的慢消费者
+    void pauseReading() { reading_paused.store(true, std::memory_order_relaxed); }
+
+    struct TrafficStats {
+        uint64_t frames_received = 0;
+        uint64_t wire_bytes_received = 0;    // 含帧头，压缩后的实际字节
+        uint64_t decoded_bytes_received = 0; // 解压后的消息体字节
+        uint64_t decompress_ns = 0;
+        uint64_t wire_bytes_sent = 0;
+    };
+    TrafficStats getTrafficStats() const;
 protected:
     virtual void handle_server_message(const Envelope& envelope); // 处理收到的消息
 private:
@@ -31,6 +51,7 @@ private:
     void handle_write(const asio::error_code& ec, size_t bytes_transferred);
 
     void handle_error(const std::string& where, const asio::error_code& ec);
+    void noteSeq(const chat::MessageBroadcast& msg);
 
     asio::io_context& io_context;
     asio::ip::tcp::socket socket;
@@ -38,10 +59,23 @@ private:
     
     std::array<char, 4> read_header;
     std::vector<char> read_body;
+    bool read_compressed = false;
+    std::atomic<bool> reading_paused{false};
+
+    std::shared_ptr<const ZstdCompressor> compressor;
+    std::atomic<bool> compression_active{false};
+    std::atomic<uint32_t> compression_min_size{0};
+    std::atomic<uint64_t> frames_received{0};
+    std::atomic<uint64_t> wire_bytes_received{0};
+    std::atomic<uint64_t> decoded_bytes_received{0};
+    std::atomic<uint64_t> decompress_ns{0};
+    std::atomic<uint64_t> wire_bytes_sent{0};
     
     std::deque<std::string> write_queue;
     uint32_t header = 4;
     static const uint32_t max_body_length = 8192;
 
     std::string currentRoom;
+    mutable std::mutex seq_mutex;
+    std::unordered_map<std::string, long long> lastSeenSeq;
 };
\ No newline at end of file
@@ -23,7 +23,8 @@ void print_help() {
         << "/login <username> <password>\n"
         << "/create <room_name>\n"
         << "/join <room_name>\n"
-        << "/leave\n"
+        << "/leave [room_name]\n"
+        << "/sync  (fetch messages missed in the current room)\n"
         << "/quit\n"
         << "@<username> <message>  (to send a private message)\n"
         << "any other text for public message in the current room.\n"
@@ -76,8 +77,26 @@ void handle_user_input() {
             std::string roomName = line.substr(6);
             auto* req = envelope.mutable_room_operation_request();
             req->set_operation(chat::RoomOperation::JOIN);
+            req->set_want_snapshot(true);
             req->set_room_name(roomName);
         }
+        else if (line.rfind("/leave ", 0) == 0) {
+            auto* req = envelope.mutable_room_operation_request();
+            req->set_operation(chat::RoomOperation::LEAVE);
+            req->set_room_name(line.substr(7));
+        }
+        else if (line == "/sync") {
+            std::string currentRoom = client->getCurrentRoom();
+            if (currentRoom.empty()) {
+                std::cout << "[System] You are not in any room to sync." << std::endl;
+                should_send = false;
+            }
+            else {
+                auto* req = envelope.mutable_sync_request();
+                req->set_room_name(currentRoom);
+                req->set_since_seq(client->getLastSeenSeq(currentRoom));
+            }
+        }
         else if (line == "/leave") {
             std::string currentRoom = client->getCurrentRoom();
             if (currentRoom.empty()) {
@@ -100,6 +119,7 @@ void handle_user_input() {
             }
             else {
                 envelope.mutable_public_message()->set_content(line);
+                envelope.mutable_public_message()->set_room_name(client->getCurrentRoom());
             }
         }
         if (should_send) {
@@ -110,8 +130,8 @@ void handle_user_input() {
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: chat_client <host> <port>\n";
+    if (argc != 3 && argc != 4) {
+        std::cerr << "Usage: chat_client <host> <port> [zstd|<zstd_dictionary>]\n";
         return 1;
     }
     signal(SIGINT, signal_handler);
@@ -119,6 +139,13 @@ int main(int argc, char* argv[]) {
     try {
         io_context = std::make_unique<asio::io_context>();
         client = std::make_shared<Client>(*io_context);
+        if (argc == 4) {
+            auto compressor = std::make_shared<ZstdCompressor>();
+            if (std::string(argv[3]) != "zstd" && !compressor->loadDictionary(argv[3])) {
+                std::cerr << "[System] Failed to load dictionary, using zstd without dictionary.\n";
+            }
+            client->enableCompression(compressor);
+        }
         client->connect(argv[1], std::stoi(argv[2]),
             [](const asio::error_code& ec) {
                 if (!ec) {
@@ -0,0 +1,48 @@
+#include "CaptureFile.h"
+#include "FrameCodec.h"
+#include <array>
+#include <cstring>
+
+namespace {
+    void writeU64(char* dst, uint64_t value) {
+        for (int i = 7; i >= 0; --i) {
+            dst[i] = static_cast<char>(value & 0xff);
+            value >>= 8;
+        }
+    }
+    uint64_t readU64(const char* src) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value = (value << 8) | static_cast<unsigned char>(src[i]);
+        }
+        return value;
+    }
+}
+
+void CaptureFile::appendRecord(std::string& out, uint64_t offsetUs, uint64_t connectionId, const char* body, size_t size) {
+    const size_t start = out.size();
+    out.resize(start + record_prefix_length + FrameCodec::header_length);
+    writeU64(&out[start], offsetUs);
+    writeU64(&out[start + 8], connectionId);
+    FrameCodec::writeHeader(&out[start + record_prefix_length], static_cast<uint32_t>(size), false);
+    out.append(body, size);
+}
+
+bool CaptureReader::open(const std::string& path) {
+    in.open(path, std::ios::binary);
+    char header[sizeof(CaptureFile::magic)];
+    return in.read(header, sizeof(header)) && std::memcmp(header, CaptureFile::magic, sizeof(header)) == 0;
+}
+bool CaptureReader::next(CaptureRecord& record) {
+    char prefix[CaptureFile::record_prefix_length];
+    std::array<char, FrameCodec::header_length> frameHeader;
+    if (!in.read(prefix, sizeof(prefix)) || !in.read(frameHeader.data(), frameHeader.size())) {
+        return false;
+    }
+    bool compressed = false;
+    const uint32_t length = FrameCodec::readHeader(frameHeader, compressed);
+    record.offsetUs = readU64(prefix);
+    record.connectionId = readU64(prefix + 8);
+    record.body.resize(length);
+    return length == 0 || static_cast<bool>(in.read(&record.body[0], length));
+}
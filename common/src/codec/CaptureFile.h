@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// 流量抓包文件格式：8 字节魔数，之后是连续的记录。
+// 每条记录 = 8 字节网络序时间偏移(微秒) + 8 字节网络序连接 id + 一个原始帧（4 字节长度 + 未压缩的 Envelope）。
+// 消息体长度为 0 的记录表示该连接在此时断开。
+struct CaptureRecord {
+    uint64_t offsetUs = 0;
+    uint64_t connectionId = 0;
+    std::string body;
+    bool isClose() const { return body.empty(); }
+};
+
+class CaptureFile {
+public:
+    CaptureFile() = delete;
+    static constexpr char magic[8] = { 'C', 'H', 'A', 'T', 'C', 'A', 'P', '1' };
+    static constexpr size_t record_prefix_length = 16;
+
+    static void appendRecord(std::string& out, uint64_t offsetUs, uint64_t connectionId, const char* body, size_t size);
+};
+
+// 顺序读取抓包文件，不把整个文件载入内存
+class CaptureReader {
+public:
+    bool open(const std::string& path);
+    // 读到文件末尾或遇到截断的记录时返回 false
+    bool next(CaptureRecord& record);
+private:
+    std::ifstream in;
+};
@@ -0,0 +1,46 @@
+#include "FrameCodec.h"
+#include "ZstdCompressor.h"
+#include <cstring>
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <arpa/inet.h>
+#endif
+
+void FrameCodec::writeHeader(char* dst, uint32_t body_length, bool compressed) {
+    uint32_t header = htonl(compressed ? (body_length | compressed_flag) : body_length);
+    std::memcpy(dst, &header, sizeof(header));
+}
+uint32_t FrameCodec::readHeader(const std::array<char, header_length>& header, bool& compressed) {
+    uint32_t value;
+    std::memcpy(&value, header.data(), sizeof(value));
+    value = ntohl(value);
+    compressed = (value & compressed_flag) != 0;
+    return value & ~compressed_flag;
+}
+std::string FrameCodec::encode(const std::string& body, const ZstdCompressor* compressor, size_t minSize) {
+    std::string frame;
+    if (compressor && body.size() >= minSize) {
+        std::string compressed;
+        if (compressor->compress(body.data(), body.size(), compressed) && compressed.size() < body.size()) {
+            frame.resize(header_length);
+            writeHeader(frame.data(), static_cast<uint32_t>(compressed.size()), true);
+            frame.append(compressed);
+            return frame;
+        }
+    }
+    frame.resize(header_length);
+    writeHeader(frame.data(), static_cast<uint32_t>(body.size()), false);
+    frame.append(body);
+    return frame;
+}
+bool FrameCodec::decode(const char* body, size_t size, bool compressed, const ZstdCompressor* compressor, size_t maxSize, std::string& out) {
+    if (!compressed) {
+        out.assign(body, size);
+        return true;
+    }
+    if (!compressor) {
+        return false;
+    }
+    return compressor->decompress(body, size, maxSize, out);
+}
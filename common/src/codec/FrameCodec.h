@@ -0,0 +1,22 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+class ZstdCompressor;
+
+// "长度-内容" 帧格式：4 字节网络序长度 + 消息体。
+// 长度最高位为压缩标志，置位时消息体是 zstd 压缩后的 Envelope。
+class FrameCodec {
+public:
+    FrameCodec() = delete;
+    static constexpr size_t header_length = 4;
+    static constexpr uint32_t compressed_flag = 0x80000000u;
+
+    static void writeHeader(char* dst, uint32_t body_length, bool compressed);
+    static uint32_t readHeader(const std::array<char, header_length>& header, bool& compressed);
+    // 消息体达到 minSize 且压缩后更小时输出压缩帧，否则输出原始帧
+    static std::string encode(const std::string& body, const ZstdCompressor* compressor = nullptr, size_t minSize = 0);
+    static bool decode(const char* body, size_t size, bool compressed, const ZstdCompressor* compressor, size_t maxSize, std::string& out);
+};
@@ -0,0 +1,101 @@
+#include "ZstdCompressor.h"
+#include <zstd.h>
+#include <zdict.h>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+
+namespace {
+    struct CCtxDeleter { void operator()(ZSTD_CCtx* ctx) const { ZSTD_freeCCtx(ctx); } };
+    struct DCtxDeleter { void operator()(ZSTD_DCtx* ctx) const { ZSTD_freeDCtx(ctx); } };
+
+    ZSTD_CCtx* threadCCtx() {
+        thread_local std::unique_ptr<ZSTD_CCtx, CCtxDeleter> ctx(ZSTD_createCCtx());
+        return ctx.get();
+    }
+    ZSTD_DCtx* threadDCtx() {
+        thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter> ctx(ZSTD_createDCtx());
+        return ctx.get();
+    }
+}
+
+void ZstdCompressor::CDictDeleter::operator()(ZSTD_CDict_s* dict) const { ZSTD_freeCDict(dict); }
+void ZstdCompressor::DDictDeleter::operator()(ZSTD_DDict_s* dict) const { ZSTD_freeDDict(dict); }
+
+ZstdCompressor::ZstdCompressor(int level) : level(level) {}
+ZstdCompressor::~ZstdCompressor() = default;
+
+bool ZstdCompressor::loadDictionary(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "[Compression] Could not open dictionary file '" << path << "'." << std::endl;
+        return false;
+    }
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return setDictionary(bytes);
+}
+bool ZstdCompressor::setDictionary(const std::string& dictionaryBytes) {
+    unsigned id = ZDICT_getDictID(dictionaryBytes.data(), dictionaryBytes.size());
+    if (id == 0) {
+        std::cerr << "[Compression] Invalid zstd dictionary." << std::endl;
+        return false;
+    }
+    dictionary = dictionaryBytes;
+    cdict.reset(ZSTD_createCDict(dictionary.data(), dictionary.size(), level));
+    ddict.reset(ZSTD_createDDict(dictionary.data(), dictionary.size()));
+    if (!cdict || !ddict) {
+        cdict.reset();
+        ddict.reset();
+        return false;
+    }
+    dictionaryId = id;
+    return true;
+}
+bool ZstdCompressor::compress(const char* src, size_t size, std::string& out) const {
+    out.resize(ZSTD_compressBound(size));
+    size_t written = cdict
+        ? ZSTD_compress_usingCDict(threadCCtx(), out.data(), out.size(), src, size, cdict.get())
+        : ZSTD_compressCCtx(threadCCtx(), out.data(), out.size(), src, size, level);
+    if (ZSTD_isError(written)) {
+        out.clear();
+        return false;
+    }
+    out.resize(written);
+    return true;
+}
+bool ZstdCompressor::decompress(const char* src, size_t size, size_t maxSize, std::string& out) const {
+    unsigned long long contentSize = ZSTD_getFrameContentSize(src, size);
+    if (contentSize == ZSTD_CONTENTSIZE_ERROR || contentSize == ZSTD_CONTENTSIZE_UNKNOWN || contentSize > maxSize) {
+        return false;
+    }
+    unsigned frameDictId = ZSTD_getDictID_fromFrame(src, size);
+    if (frameDictId != 0 && frameDictId != dictionaryId) {
+        return false;
+    }
+    out.resize(static_cast<size_t>(contentSize));
+    size_t written = frameDictId != 0
+        ? ZSTD_decompress_usingDDict(threadDCtx(), out.data(), out.size(), src, size, ddict.get())
+        : ZSTD_decompressDCtx(threadDCtx(), out.data(), out.size(), src, size);
+    if (ZSTD_isError(written) || written != contentSize) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+std::string ZstdCompressor::trainDictionary(const std::vector<std::string>& samples, size_t capacity) {
+    std::string buffer;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (const auto& sample : samples) {
+        buffer.append(sample);
+        sizes.push_back(sample.size());
+    }
+    std::string dictionary(capacity, '\0');
+    size_t written = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), buffer.data(), sizes.data(), static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(written)) {
+        std::cerr << "[Compression] Dictionary training failed: " << ZDICT_getErrorName(written) << std::endl;
+        return "";
+    }
+    dictionary.resize(written);
+    return dictionary;
+}
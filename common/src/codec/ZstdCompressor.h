@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+// zstd 压缩器，可选加载离线训练的字典。
+// 压缩/解压上下文按线程缓存，同一个实例可以在多个 io 线程间共享。
+class ZstdCompressor {
+public:
+    explicit ZstdCompressor(int level = 3);
+    ~ZstdCompressor();
+    ZstdCompressor(const ZstdCompressor&) = delete;
+    ZstdCompressor& operator=(const ZstdCompressor&) = delete;
+
+    bool loadDictionary(const std::string& path);
+    bool setDictionary(const std::string& dictionaryBytes);
+    uint32_t getDictionaryId() const { return dictionaryId; }
+
+    bool compress(const char* src, size_t size, std::string& out) const;
+    bool decompress(const char* src, size_t size, size_t maxSize, std::string& out) const;
+
+    // 用抓取到的消息体样本训练字典，失败时返回空串
+    static std::string trainDictionary(const std::vector<std::string>& samples, size_t capacity = 16 * 1024);
+private:
+    struct CDictDeleter { void operator()(ZSTD_CDict_s* dict) const; };
+    struct DDictDeleter { void operator()(ZSTD_DDict_s* dict) const; };
+
+    int level;
+    uint32_t dictionaryId = 0;
+    std::string dictionary;
+    std::unique_ptr<ZSTD_CDict_s, CDictDeleter> cdict;
+    std::unique_ptr<ZSTD_DDict_s, DDictDeleter> ddict;
+};
@@ -19,12 +19,16 @@ public:
     const std::string& getContent() const { return content; }
     void setContent(const std::string& newContent) { content = newContent; }
 
+    long long getRoomSeq() const { return room_seq; }
+    void setRoomSeq(long long newRoomSeq) { room_seq = newRoomSeq; }
+
     const std::chrono::system_clock::time_point& getCreatedAt() const { return created_at; }
     void setCreatedAt(const std::chrono::system_clock::time_point& newCreatedAt) { created_at = newCreatedAt; }
 private:
     long long id;
     long long room_id;
     long long sender_id;
+    long long room_seq = 0; // 房间内序号，0 表示未分配
     std::string content;
     std::chrono::system_clock::time_point created_at;
 };
\ No newline at end of file
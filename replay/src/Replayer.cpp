@@ -0,0 +1,133 @@
+#include "Replayer.h"
+#include "codec/CaptureFile.h"
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+ReplayClient::ReplayClient(asio::io_context& io_context, ReplayCounters& counters)
+    : Client(io_context), counters(counters) {}
+
+void ReplayClient::start(const std::string& host, unsigned short port) {
+    auto self = std::static_pointer_cast<ReplayClient>(shared_from_this());
+    connect(host, port, [this, self](const asio::error_code& ec) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (ec) {
+            counters.connectFailures.fetch_add(1, std::memory_order_relaxed);
+            pending.clear();
+            return;
+        }
+        connected = true;
+        while (!pending.empty()) {
+            send(pending.front());
+            counters.framesSent.fetch_add(1, std::memory_order_relaxed);
+            pending.pop_front();
+        }
+    });
+}
+void ReplayClient::deliver(const Envelope& envelope) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!connected) {
+        pending.push_back(envelope);
+        return;
+    }
+    send(envelope);
+    counters.framesSent.fetch_add(1, std::memory_order_relaxed);
+}
+void ReplayClient::handle_server_message(const Envelope&) {
+    // 只计数，不打印也不自动回复心跳，心跳回复已经在抓包里
+    counters.framesReceived.fetch_add(1, std::memory_order_relaxed);
+}
+
+namespace {
+    void fillPassword(Envelope& envelope, const std::string& password) {
+        if (envelope.has_login_request()) {
+            envelope.mutable_login_request()->set_password(password);
+        } else if (envelope.has_registration_request()) {
+            envelope.mutable_registration_request()->set_password(password);
+        } else if (envelope.has_change_password_request()) {
+            envelope.mutable_change_password_request()->set_old_password(password);
+            envelope.mutable_change_password_request()->set_new_password(password);
+        }
+    }
+}
+
+Replayer::Replayer(ReplayOptions options) : options(std::move(options)) {}
+
+int Replayer::run() {
+    CaptureReader reader;
+    if (!reader.open(options.capturePath)) {
+        std::cerr << "Cannot open capture file: " << options.capturePath << std::endl;
+        return 1;
+    }
+    asio::io_context io_context;
+    auto work_guard = asio::make_work_guard(io_context);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.threads; ++i) {
+        threads.emplace_back([&io_context]() { io_context.run(); });
+    }
+
+    std::unordered_map<uint64_t, std::shared_ptr<ReplayClient>> clients;
+    // Client::close 投递的回调只捕获 this，已关闭的连接保留到结束再释放
+    std::vector<std::shared_ptr<ReplayClient>> closed;
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t records = 0;
+    uint64_t skipped = 0;
+    int64_t maxLagUs = 0;
+    CaptureRecord record;
+    while (reader.next(record)) {
+        ++records;
+        const auto target = start + std::chrono::microseconds(static_cast<int64_t>(record.offsetUs / options.speed));
+        std::this_thread::sleep_until(target);
+        const int64_t lagUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - target).count();
+        maxLagUs = std::max(maxLagUs, lagUs);
+
+        auto it = clients.find(record.connectionId);
+        if (record.isClose()) {
+            if (it != clients.end()) {
+                it->second->close();
+                closed.push_back(std::move(it->second));
+                clients.erase(it);
+            }
+            continue;
+        }
+        Envelope envelope;
+        // 重放客户端不带字典，压缩协商帧直接跳过，服务器会一直发原始帧
+        if (!envelope.ParseFromString(record.body) || envelope.has_compression_hello()) {
+            ++skipped;
+            continue;
+        }
+        if (!options.password.empty()) {
+            fillPassword(envelope, options.password);
+        }
+        if (it == clients.end()) {
+            auto client = std::make_shared<ReplayClient>(io_context, counters);
+            client->start(options.host, options.port);
+            counters.connections.fetch_add(1, std::memory_order_relaxed);
+            it = clients.emplace(record.connectionId, std::move(client)).first;
+        }
+        it->second->deliver(envelope);
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::this_thread::sleep_for(std::chrono::seconds(options.drainSeconds));
+    for (auto& [id, client] : clients) {
+        client->close();
+    }
+    work_guard.reset();
+    io_context.stop();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::cout << "\n--- Replay Summary ---\n"
+              << "Capture:            " << options.capturePath << "\n"
+              << "Speed:              " << options.speed << "x\n"
+              << "Records read:       " << records << " (" << skipped << " skipped)\n"
+              << "Connections:        " << counters.connections.load() << " (" << counters.connectFailures.load() << " failed)\n"
+              << "Frames sent:        " << counters.framesSent.load() << "\n"
+              << "Frames received:    " << counters.framesReceived.load() << "\n"
+              << "Replay duration:    " << elapsed << " s\n"
+              << "Max schedule lag:   " << maxLagUs / 1000.0 << " ms" << std::endl;
+    return 0;
+}
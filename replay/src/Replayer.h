@@ -0,0 +1,51 @@
+#pragma once
+
+#include <asio.hpp>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "client.h"
+
+struct ReplayOptions {
+    std::string capturePath;
+    std::string host;
+    unsigned short port = 0;
+    double speed = 1.0; // 重放速度倍数，2 表示两倍速
+    int threads = 2;
+    int drainSeconds = 5; // 重放结束后等待服务器响应的时间
+    std::string password; // 抓包中的密码已被清空，重放时给登录、注册和修改密码请求统一补上
+};
+
+struct ReplayCounters {
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> framesSent{0};
+    std::atomic<uint64_t> framesReceived{0};
+    std::atomic<uint64_t> connectFailures{0};
+};
+
+// 抓包中的一个连接。连接建立前到达的帧先缓存，连上后按顺序发出
+class ReplayClient : public Client {
+public:
+    ReplayClient(asio::io_context& io_context, ReplayCounters& counters);
+    void start(const std::string& host, unsigned short port);
+    void deliver(const Envelope& envelope);
+protected:
+    void handle_server_message(const Envelope& envelope) override;
+private:
+    ReplayCounters& counters;
+    std::mutex mtx;
+    bool connected = false;
+    std::deque<Envelope> pending;
+};
+
+// 按抓包中记录的时间间隔（除以 speed）重放每个连接的入站帧
+class Replayer {
+public:
+    explicit Replayer(ReplayOptions options);
+    int run();
+private:
+    ReplayOptions options;
+    ReplayCounters counters;
+};
@@ -0,0 +1,33 @@
+#include "Replayer.h"
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: replay <capture file> <host> <port> [--speed <n>] [--threads <n>] [--drain-seconds <n>] [--password <p>]" << std::endl;
+        return 1;
+    }
+    ReplayOptions options;
+    options.capturePath = argv[1];
+    options.host = argv[2];
+    options.port = static_cast<unsigned short>(std::stoi(argv[3]));
+    for (int i = 4; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--speed") {
+            options.speed = std::stod(argv[i + 1]);
+        } else if (flag == "--threads") {
+            options.threads = std::stoi(argv[i + 1]);
+        } else if (flag == "--drain-seconds") {
+            options.drainSeconds = std::stoi(argv[i + 1]);
+        } else if (flag == "--password") {
+            options.password = argv[i + 1];
+        } else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+    if (options.speed <= 0 || options.threads <= 0) {
+        std::cerr << "--speed and --threads must be positive" << std::endl;
+        return 1;
+    }
+    return Replayer(options).run();
+}
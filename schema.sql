@@ -27,11 +27,13 @@ CREATE TABLE `messages` (
   `id` bigint(20) NOT NULL AUTO_INCREMENT,
   `room_id` int(11) NOT NULL,
   `sender_id` int(11) NOT NULL,
+  `room_seq` bigint(20) NOT NULL DEFAULT 0,
   `content` text NOT NULL,
   `created_at` timestamp NULL DEFAULT current_timestamp(),
   PRIMARY KEY (`id`),
   KEY `sender_id` (`sender_id`),
   KEY `idx_messages_room_id_created_at` (`room_id`,`created_at` DESC),
+  KEY `idx_messages_room_id_room_seq` (`room_id`,`room_seq`),
   CONSTRAINT `messages_ibfk_1` FOREIGN KEY (`room_id`) REFERENCES `rooms` (`id`),
   CONSTRAINT `messages_ibfk_2` FOREIGN KEY (`sender_id`) REFERENCES `users` (`id`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_unicode_ci;
@@ -7,71 +7,218 @@
 #include "service/AuthService.h"
 #include "service/RoomService.h"
 #include "service/MessageService.h"
+#include "service/EphemeralService.h"
+#include "session/FrameBufferPool.h"
+#include "session/OutboundQueue.h"
+#include "telemetry/Metrics.h"
+#include "telemetry/Tracer.h"
+#include "util/Logger.h"
 #include "Server.h"
-#include <iostream>
+
+namespace {
+    // 一次分发的耗时记入总直方图和按类型的直方图；超出预算时带上类型与用户写警告日志。
+    // 分发期间当前线程的开始时间对 LagMonitor 可见
+    class DispatchTimer {
+    public:
+        DispatchTimer(Histogram& total, Histogram* byType, uint64_t budgetNs, const std::shared_ptr<Session>& session, int payload)
+            : total(total), byType(byType), budgetNs(budgetNs), session(session), payload(payload), start(std::chrono::steady_clock::now()) {
+            LagMonitor::handlerStarted(start);
+        }
+        ~DispatchTimer() {
+            LagMonitor::handlerFinished();
+            const auto elapsedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            total.observe(elapsedNs);
+            if (byType) {
+                byType->observe(elapsedNs);
+            }
+            if (budgetNs != 0 && elapsedNs > budgetNs) {
+                const auto* field = chat::Envelope::descriptor()->FindFieldByNumber(payload);
+                LOG_WARN("slow_handler", "payload", field ? field->name() : std::to_string(payload),
+                    "user_id", session->isAuthenticated() ? session->getUserId() : 0LL,
+                    "duration_ms", static_cast<double>(elapsedNs) / 1e6);
+            }
+        }
+    private:
+        Histogram& total;
+        Histogram* byType;
+        uint64_t budgetNs;
+        const std::shared_ptr<Session>& session;
+        int payload;
+        std::chrono::steady_clock::time_point start;
+    };
+}
 
 Server::Server(asio::io_context& io_context,unsigned short port)
+:Server(io_context, std::make_unique<MySQLUserRepository>(), std::make_unique<MySQLRoomRepository>(), std::make_unique<MySQLMessageRepository>()) {
+    const asio::ip::tcp::endpoint endpoint(asio::ip::tcp::v4(), port);
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+    acceptor.bind(endpoint);
+    acceptor.listen();
+}
+Server::Server(asio::io_context& io_context, std::unique_ptr<IUserRepository> users,
+               std::unique_ptr<IRoomRepository> rooms, std::unique_ptr<IMessageRepository> messages)
 :ioc(io_context),
- acceptor(io_context, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port)),
- logStrand(asio::make_strand(io_context.get_executor())) {
-
-    userRepository = std::make_unique<MySQLUserRepository>();
-    roomRepository = std::make_unique<MySQLRoomRepository>();
-    messageRepository = std::make_unique<MySQLMessageRepository>();
+ acceptor(io_context),
+ statsTimer(io_context),
+ userRepository(std::move(users)),
+ roomRepository(std::move(rooms)),
+ messageRepository(std::move(messages)) {
 
     sessionManager = std::make_unique<SessionManager>(getMutex());
     authService = std::make_unique<AuthService>(userRepository.get(), sessionManager.get());
     roomService = std::make_unique<RoomService>(getMutex(), roomRepository.get(), userRepository.get(), messageRepository.get(), sessionManager.get());
     messageService = std::make_unique<MessageService>(messageRepository.get(), sessionManager.get(), roomService.get());
+    ephemeralService = std::make_unique<EphemeralService>(ioc, roomService.get());
+
+    auto& registry = MetricsRegistry::getInstance();
+    const auto* descriptor = chat::Envelope::descriptor();
+    for (int i = 0; i < descriptor->field_count(); ++i) {
+        const auto* field = descriptor->field(i);
+        if (!field->containing_oneof()) {
+            continue;
+        }
+        if (requestCounters.size() <= static_cast<size_t>(field->number())) {
+            requestCounters.resize(field->number() + 1, nullptr);
+            handlerDurations.resize(field->number() + 1, nullptr);
+        }
+        requestCounters[field->number()] = &registry.counter("chat_requests_total",
+            "Inbound envelopes dispatched, by payload type", "type=\"" + field->name() + "\"");
+        handlerDurations[field->number()] = &registry.histogram("chat_handler_duration_seconds",
+            "Time spent handling one inbound envelope, by payload type", MetricsRegistry::latencyBucketsNs(), 1e9,
+            "type=\"" + field->name() + "\"");
+    }
+    dispatchDuration = &registry.histogram("chat_dispatch_duration_seconds",
+        "Time spent in Server::dispatchMessage", MetricsRegistry::latencyBucketsNs(), 1e9);
 }
 Server::~Server() = default;
 
-std::recursive_mutex& Server::getMutex() {
+ServerMutex& Server::getMutex() {
     return mtx;
 }
 void Server::run(){
     start_accept();
 }
+void Server::stop(){
+    asio::post(ioc, [this]() {
+        asio::error_code ignored;
+        acceptor.close(ignored);
+        statsTimer.cancel();
+        for (auto& wheel : timerWheels) {
+            wheel->stop();
+        }
+        if (lagMonitor) {
+            lagMonitor->stop();
+        }
+        roomService->stopPresenceBatching();
+        ephemeralService->stop();
+    });
+}
+void Server::startStatsReport(std::chrono::seconds interval){
+    statsInterval = interval;
+    if (statsInterval.count() > 0) {
+        schedule_stats_report();
+    }
+}
+void Server::enableHeartbeat(const HeartbeatConfig& config, size_t wheelCount){
+    for (size_t i = 0; i < wheelCount; ++i) {
+        timerWheels.push_back(std::make_unique<TimerWheel>(ioc, config));
+        timerWheels.back()->start();
+    }
+}
+void Server::enableLagMonitor(const LagMonitorConfig& config){
+    lagMonitor = std::make_unique<LagMonitor>(config);
+    lagMonitor->start();
+}
+void Server::enablePresenceBatching(const PresenceConfig& config){
+    roomService->enablePresenceBatching(ioc, config);
+}
+void Server::setRoomSnapshotConfig(const RoomSnapshotConfig& config){
+    roomService->setSnapshotConfig(config);
+}
+void Server::setEphemeralInterval(std::chrono::milliseconds interval){
+    ephemeralService->setMinInterval(interval);
+}
+void Server::setStrandPoolSize(size_t size){
+    strandPool.clear();
+    for (size_t i = 0; i < size; ++i) {
+        strandPool.push_back(asio::make_strand(asio::any_io_executor(ioc.get_executor())));
+    }
+}
+asio::strand<asio::any_io_executor> Server::sessionStrand(uint64_t sessionId){
+    // 每个会话独占 strand 要单独分配一份实现，百万连接时改为按 ID 共享一个固定的池
+    if (strandPool.empty()) {
+        return asio::make_strand(asio::any_io_executor(ioc.get_executor()));
+    }
+    return strandPool[sessionId % strandPool.size()];
+}
+void Server::setHandlerBudget(std::chrono::milliseconds budget){
+    handlerBudgetNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(budget).count());
+}
+void Server::schedule_stats_report(){
+    statsTimer.expires_after(statsInterval);
+    statsTimer.async_wait([this](const asio::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        LOG_INFO("outbound_stats", "summary", OutboundQueue::describeStats());
+        LOG_INFO("frame_buffer_stats", "summary", FrameBufferPool::describeStats());
+        LockProfiler::getInstance().logSummary();
+        schedule_stats_report();
+    });
+}
 void Server::start_accept(){
-    std::shared_ptr<asio::ip::tcp::socket> sock_ptr = std::make_shared<asio::ip::tcp::socket>(ioc);
-    acceptor.async_accept(*sock_ptr,
-        [this,sock_ptr](const asio::error_code& ec){
-            handle_accept(ec,std::make_shared<Session>(sock_ptr,*this));
+    acceptor.async_accept(
+        [this](const asio::error_code& ec, asio::ip::tcp::socket socket){
+            handle_accept(ec, std::move(socket));
         }
     );
 }
-void Server::handle_accept(const asio::error_code& ec, std::shared_ptr<Session> session){
+void Server::handle_accept(const asio::error_code& ec, asio::ip::tcp::socket socket){
     if(!ec){
         try{
-            std::cout<<"New connection from "<<session->socket_ptr->remote_endpoint().address().to_string()<<":"<<session->socket_ptr->remote_endpoint().port()<<std::endl; 
+            const auto remote = socket.remote_endpoint();
+            LOG_INFO("connection_accepted", "address", remote.address().to_string(), "port", remote.port());
+            auto session = Session::create(std::move(socket), *this);
             session->start();
+            if (!timerWheels.empty()) {
+                timerWheels[nextTimerWheel.fetch_add(1, std::memory_order_relaxed) % timerWheels.size()]->add(session);
+            }
         }catch(const std::exception& e){
-            std::cerr<<"Exception in starting session: "<<e.what()<<std::endl;
+            LOG_ERROR("session_start_failed", "error", e.what());
         }
     }else {
-        std::cout << "Error accepting connection: " << ec.message() << std::endl;
+        LOG_WARN("accept_failed", "error", ec.message());
+    }
+    if (!acceptor.is_open()) {
+        return;
     }
     start_accept();
 }
 void Server::onMessage(std::shared_ptr<Session> session, const chat::Envelope& envelope){
     if (session->isAuthenticated()) {
-        std::cout << "Received message from user '" << session->getUsername() 
-                  << "' (ID: " << session->getUserId() << "). "
-                  << "Payload type: " << envelope.payload_case() << std::endl;
+        LOG_DEBUG("message_received", "user_id", session->getUserId(), "payload", envelope.payload_case());
     } else {
-        std::cout << "Received message from an unauthenticated session. "
-                  << "Payload type: " << envelope.payload_case() << std::endl;
+        LOG_DEBUG("message_received", "user_id", "anonymous", "payload", envelope.payload_case());
     }
-    asio::post(ioc, [this, session, envelope]() {
+    // 采样到的请求把上下文带过 post 这一跳，记录在队列中等待的时间
+    const TraceContext trace = Tracer::current();
+    const int64_t postedUs = trace ? Tracer::nowUs() : 0;
+    asio::post(ioc, [this, session, envelope, trace, postedUs]() {
+        TraceScope trace_scope(trace);
+        Tracer::getInstance().emit("server.post_hop", postedUs, Tracer::nowUs());
         dispatchMessage(session, envelope);
     });
 }
-void Server::postLog(const std::string& message) {
-    asio::post(logStrand, [message]() {
-        std::cout << message << std::endl;
-        });
-}
 void Server::dispatchMessage(std::shared_ptr<Session> session, const chat::Envelope& envelope){
+    TraceSpan span("server.dispatch");
+    const size_t payloadType = static_cast<size_t>(envelope.payload_case());
+    if (payloadType < requestCounters.size() && requestCounters[payloadType]) {
+        requestCounters[payloadType]->inc();
+    }
+    DispatchTimer timer(*dispatchDuration, payloadType < handlerDurations.size() ? handlerDurations[payloadType] : nullptr,
+        handlerBudgetNs, session, envelope.payload_case());
     switch(envelope.payload_case()){
         case chat::Envelope::kLoginRequest:
             authService->handleLogin(session,envelope.login_request());
@@ -79,12 +226,22 @@ void Server::dispatchMessage(std::shared_ptr<Session> session, const chat::Envel
         case chat::Envelope::kRegistrationRequest:
             authService->handleRegister(session,envelope.registration_request());
             return;
+        case chat::Envelope::kCompressionHello:
+            session->negotiateCompression(envelope.compression_hello());
+            return;
+        case chat::Envelope::kPing: {
+            chat::Envelope pong;
+            pong.mutable_pong()->set_timestamp_ms(envelope.ping().timestamp_ms());
+            session->send(pong);
+            return;
+        }
+        case chat::Envelope::kPong:
+            return;
         default:
             break;
     }
     if (!session->isAuthenticated()) {
-        std::cerr << "Warning: Unauthenticated session tried to send an authenticated-only request. Payload type: "
-                  << envelope.payload_case() << std::endl;
+        LOG_WARN("unauthenticated_request", "payload", envelope.payload_case());
         chat::Envelope response_envelope;
         auto* err_resp = response_envelope.mutable_error_response();
         err_resp->set_error_message("Authentication required.");
@@ -111,21 +268,24 @@ void Server::dispatchMessage(std::shared_ptr<Session> session, const chat::Envel
         case chat::Envelope::kHistoryMessageRequest:
             roomService->handleHistoryRequest(session,envelope.history_message_request());
             break;
+        case chat::Envelope::kSyncRequest:
+            roomService->handleSyncRequest(session,envelope.sync_request());
+            break;
+        case chat::Envelope::kEphemeralSignal:
+            ephemeralService->handleSignal(session,envelope.ephemeral_signal());
+            break;
         default:
-            std::cerr << "Warning: Received Envelope with unknown payload type: " 
-                      << envelope.payload_case() << std::endl;
+            LOG_WARN("unknown_payload", "payload", envelope.payload_case());
             break;
     }
 }
 void Server::onDisconnect(std::shared_ptr<Session> session){
     asio::post(ioc, [this, session]() {
         if (session->isAuthenticated()) {
-            std::string logMsg = "[INFO] User '" + session->getUsername() +
-                "' (ID: " + std::to_string(session->getUserId()) + ") disconnected.";
-            postLog(logMsg);
+            LOG_INFO("user_disconnected", "user", session->getUsername(), "user_id", session->getUserId());
             roomService->handleDisconnect(session);
         } else {
-            postLog("[INFO] An anonymous connection closed.");
+            LOG_INFO("anonymous_disconnected");
         }
         sessionManager->remove(session);
     });
@@ -3,34 +3,75 @@
 #include <iostream>
 #include <asio.hpp>
 #include <memory>
+#include <vector>
+#include <atomic>
+#include "TimerWheel.h"
+#include "telemetry/LagMonitor.h"
+#include "telemetry/LockProfiler.h"
 
 class Session;
 class SessionManager;
 class AuthService;
 class RoomService;
 class MessageService;
+class EphemeralService;
 class IUserRepository;
 class IRoomRepository;
 class IMessageRepository;
+class Counter;
+class Histogram;
+struct PresenceConfig;
+struct RoomSnapshotConfig;
 namespace chat{
     class Envelope;
 }
 class Server{
 public:
        Server(asio::io_context& io_context,unsigned short port);
+       // 使用给定的仓储且不监听端口，供基准测试与进程内模拟使用
+       Server(asio::io_context& io_context, std::unique_ptr<IUserRepository> users,
+              std::unique_ptr<IRoomRepository> rooms, std::unique_ptr<IMessageRepository> messages);
        Server(const Server&) = delete; 
        Server& operator=(const Server&) = delete;
        ~Server(); 
        void run();
+       // 停止接受新连接并取消服务器自身的定时器，使 io_context 可以退出
+       void stop();
+       // 周期性输出出站队列深度分布等运行统计
+       void startStatsReport(std::chrono::seconds interval);
+       // 每个 io 线程一个时间轮，新会话轮流挂到各个时间轮上
+       void enableHeartbeat(const HeartbeatConfig& config, size_t wheelCount);
+       // 事件循环延迟探针
+       void enableLagMonitor(const LagMonitorConfig& config);
+       // 单次处理超过该时长时写警告日志，0 表示不检查
+       void setHandlerBudget(std::chrono::milliseconds budget);
+       // 按房间合并进出通知
+       void enablePresenceBatching(const PresenceConfig& config);
+       // 加入房间快照的复用时长、成员数上限与最近消息数
+       void setRoomSnapshotConfig(const RoomSnapshotConfig& config);
+       // 同一发送者短暂信号的最小间隔
+       void setEphemeralInterval(std::chrono::milliseconds interval);
+       // 会话共享的 strand 数，0 表示每个会话独占一个；须在接受连接之前设置
+       void setStrandPoolSize(size_t size);
+       // 会话按 ID 取得的 strand，同一 strand 上的会话串行执行
+       asio::strand<asio::any_io_executor> sessionStrand(uint64_t sessionId);
        void onMessage(std::shared_ptr<Session> session, const chat::Envelope& envelope);
        void onDisconnect(std::shared_ptr<Session> session);
-       void postLog(const std::string& message);
-       std::recursive_mutex& getMutex();
+       ServerMutex& getMutex();
 private:
-       std::recursive_mutex mtx;
+       ServerMutex mtx{"server"};
        asio::ip::tcp::acceptor acceptor;
        asio::io_context& ioc;
-       asio::strand<asio::io_context::executor_type> logStrand;
+       asio::steady_timer statsTimer;
+       std::chrono::seconds statsInterval{0};
+       std::vector<std::unique_ptr<TimerWheel>> timerWheels;
+       std::atomic<size_t> nextTimerWheel{0};
+       std::vector<asio::strand<asio::any_io_executor>> strandPool;
+       std::vector<Counter*> requestCounters; // 按 Envelope payload 字段号索引
+       Histogram* dispatchDuration = nullptr;
+       std::vector<Histogram*> handlerDurations; // 按 Envelope payload 字段号索引
+       uint64_t handlerBudgetNs = 0;
+       std::unique_ptr<LagMonitor> lagMonitor;
 
        std::unique_ptr<IUserRepository> userRepository;
        std::unique_ptr<IRoomRepository> roomRepository;
@@ -39,8 +80,10 @@ private:
        std::unique_ptr<AuthService> authService;
        std::unique_ptr<RoomService> roomService;
        std::unique_ptr<MessageService> messageService;
+       std::unique_ptr<EphemeralService> ephemeralService;
 
        void start_accept();
-       void handle_accept(const asio::error_code& ec, std::shared_ptr<Session> session);
+       void schedule_stats_report();
+       void handle_accept(const asio::error_code& ec, asio::ip::tcp::socket socket);
        void dispatchMessage(std::shared_ptr<Session> session, const chat::Envelope& envelope);
 };
\ No newline at end of file
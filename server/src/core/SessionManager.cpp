@@ -1,54 +1,87 @@
 #include "session/Session.h"
 #include "SessionManager.h"
-#include <iostream>
-SessionManager::SessionManager(std::recursive_mutex& mtx) : mtx(mtx) {}
+#include "util/Logger.h"
+SessionManager::SessionManager(ServerMutex& mtx) : mtx(mtx) {}
 void SessionManager::add(std::shared_ptr<Session> s){
-    std::lock_guard<std::recursive_mutex> lock(mtx);
+    LockGuard<ServerMutex> lock(mtx);
     sessions.insert(s);
 }
 void SessionManager::remove(std::shared_ptr<Session> s){
-    std::lock_guard<std::recursive_mutex> lock(mtx);
+    LockGuard<ServerMutex> lock(mtx);
     if (s->isAuthenticated()) {
-        sessionsByUserId.erase(s->getUserId());
-        sessionsByUsername.erase(s->getUsername());
+        unindexLocked(s.get());
     }
     sessions.erase(s);
 }
+void SessionManager::unindexLocked(Session* s){
+    auto byName = sessionsByUsername.find(s->username);
+    if (byName != sessionsByUsername.end() && byName->second == s) {
+        sessionsByUsername.erase(byName);
+    }
+    auto byId = sessionsByUserId.find(s->userId);
+    if (byId != sessionsByUserId.end() && byId->second.get() == s) {
+        sessionsByUserId.erase(byId);
+    }
+}
+void SessionManager::indexNameLocked(Session* s){
+    // 同名的旧项键引用的是旧会话的字符串，整项替换而不是只改值
+    auto byName = sessionsByUsername.find(s->username);
+    if (byName != sessionsByUsername.end()) {
+        sessionsByUsername.erase(byName);
+    }
+    sessionsByUsername.emplace(s->username, s);
+}
 void SessionManager::updateUsername(std::shared_ptr<Session> s, const std::string& newUsername){
-    std::lock_guard<std::recursive_mutex> lock(mtx);
-    sessionsByUsername.erase(s->getUsername());
+    LockGuard<ServerMutex> lock(mtx);
+    auto byName = sessionsByUsername.find(s->username);
+    const bool indexed = byName != sessionsByUsername.end() && byName->second == s.get();
+    if (indexed) {
+        sessionsByUsername.erase(byName);
+    }
     s->setUsername(newUsername);
-    sessionsByUsername[newUsername] = s;
+    if (indexed) {
+        indexNameLocked(s.get());
+    }
 }
 void SessionManager::registerAuthenticatedSession(std::shared_ptr<Session> s, long long userId, const std::string& username){
-    std::lock_guard<std::recursive_mutex> lock(mtx);
-    sessionsByUserId[userId] = s;
-    sessionsByUsername[username] = s;
+    LockGuard<ServerMutex> lock(mtx);
+    if (s->isAuthenticated()) {
+        unindexLocked(s.get());
+    }
+    // 同一用户的旧会话被顶替：先在它还被持有时撤下它的用户名索引
+    auto previous = sessionsByUserId.find(userId);
+    if (previous != sessionsByUserId.end() && previous->second != s) {
+        unindexLocked(previous->second.get());
+    }
     s->setAuthenticated(userId, username);
-    std::cout << "User " << username << " (ID: " << userId << ") authenticated and registered." << std::endl;
+    sessionsByUserId[userId] = s;
+    indexNameLocked(s.get());
+    LOG_INFO("session_authenticated", "user", username, "user_id", userId);
 }
 std::shared_ptr<Session> SessionManager::findByUsername(const std::string& username){
-    std::lock_guard<std::recursive_mutex> lock(mtx);
+    LockGuard<ServerMutex> lock(mtx);
     auto it = sessionsByUsername.find(username);
     if(it == sessionsByUsername.end()){
-        std::cout << "No session found for username: " << username << std::endl;
+        LOG_DEBUG("session_not_found", "user", username);
         return nullptr;
     }
-    return it->second;
+    return it->second->shared_from_this();
 }
 std::shared_ptr<Session> SessionManager::findByUserId(long long userId){
-    std::lock_guard<std::recursive_mutex> lock(mtx);
+    LockGuard<ServerMutex> lock(mtx);
     auto it = sessionsByUserId.find(userId);
     if(it == sessionsByUserId.end()){
-        std::cout << "No session found for user ID: " << userId << std::endl;
+        LOG_DEBUG("session_not_found", "user_id", userId);
         return nullptr;
     }
     return it->second;
 }
 void SessionManager::broadcast(const chat::Envelope& envelop){
+    LockGuard<ServerMutex> lock(mtx);
+    auto frame = OutboundFrame::encode(envelop, true);
     for(const auto& session : sessions){
         if(session->isAuthenticated()){
-            session->send(envelop);
+            session->send(frame);
         }
     }
 }
\ No newline at end of file
@@ -2,9 +2,11 @@
 
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <mutex>
 #include <unordered_set>
+#include "telemetry/LockProfiler.h"
 class Session;
 namespace chat{
     class Envelope;
@@ -12,7 +14,7 @@ namespace chat{
 
 class SessionManager {
 public:
-    explicit SessionManager(std::recursive_mutex& mtx);
+    explicit SessionManager(ServerMutex& mtx);
     ~SessionManager() = default;
     void add(std::shared_ptr<Session> s);
     void remove(std::shared_ptr<Session> s);
@@ -23,8 +25,14 @@ public:
     void broadcast(const chat::Envelope& envelope);
 
 private:
-    std::recursive_mutex& mtx;
+    // 只在索引仍指向 s 时删除，同一用户的新会话可能已经顶替了它
+    void unindexLocked(Session* s);
+    void indexNameLocked(Session* s);
+
+    ServerMutex& mtx;
     std::unordered_set<std::shared_ptr<Session>> sessions;
+    // 用户 ID 索引持有已认证的会话；用户名索引与它同进同出，只存裸指针，
+    // 键直接引用会话自己的 username，不再为每个会话多存一份 shared_ptr 和用户名拷贝
     std::unordered_map<long long, std::shared_ptr<Session>> sessionsByUserId;
-    std::unordered_map<std::string, std::shared_ptr<Session>> sessionsByUsername;
+    std::unordered_map<std::string_view, Session*> sessionsByUsername;
 };
\ No newline at end of file
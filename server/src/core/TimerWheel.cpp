@@ -0,0 +1,79 @@
+#include "TimerWheel.h"
+#include "session/Session.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel(asio::io_context& ioc, const HeartbeatConfig& config)
+    : config(config),
+      strand(asio::make_strand(ioc.get_executor())),
+      timer(ioc),
+      slots(config.slots > 0 ? config.slots : 1) {}
+
+int64_t TimerWheel::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+void TimerWheel::start() {
+    asio::post(strand, [this]() {
+        if (running) {
+            return;
+        }
+        running = true;
+        schedule_tick();
+    });
+}
+void TimerWheel::stop() {
+    asio::post(strand, [this]() {
+        running = false;
+        timer.cancel();
+    });
+}
+void TimerWheel::add(std::shared_ptr<Session> session) {
+    asio::post(strand, [this, weak = std::weak_ptr<Session>(session)]() mutable {
+        insert(std::move(weak), config.pingInterval);
+    });
+}
+void TimerWheel::schedule_tick() {
+    timer.expires_after(config.tick);
+    timer.async_wait(asio::bind_executor(strand, [this](const asio::error_code& ec) {
+        if (ec || !running) {
+            return;
+        }
+        on_tick();
+        schedule_tick();
+    }));
+}
+void TimerWheel::on_tick() {
+    cursor = (cursor + 1) % slots.size();
+    std::vector<std::weak_ptr<Session>> due;
+    due.swap(slots[cursor]);
+    const int64_t now = nowMs();
+    for (auto& weak : due) {
+        auto session = weak.lock();
+        if (!session || session->isClosed()) {
+            continue;
+        }
+        const int64_t idle = now - session->getLastActivityMs();
+        if (idle >= config.idleTimeout.count()) {
+            session->expire();
+            continue;
+        }
+        std::chrono::milliseconds next = config.pingInterval - std::chrono::milliseconds(idle);
+        if (idle >= config.pingInterval.count()) {
+            // 已经空闲一个心跳周期：发一次 Ping，之后等到超时点再检查
+            if (session->getLastPingMs() < session->getLastActivityMs()) {
+                session->sendPing(now);
+            }
+            next = config.idleTimeout - std::chrono::milliseconds(idle);
+        } else {
+            // 每个心跳周期归还一次空出站队列的存储；发 Ping 的这一轮不归还，Ping 马上又要用到
+            session->releaseIdleBuffers();
+        }
+        insert(std::move(weak), next);
+    }
+}
+void TimerWheel::insert(std::weak_ptr<Session> session, std::chrono::milliseconds delay) {
+    // 超出一圈的延迟会在转一圈后被重新检查并再次挂回
+    size_t ticks = static_cast<size_t>((delay.count() + config.tick.count() - 1) / config.tick.count());
+    ticks = std::clamp<size_t>(ticks, 1, std::max<size_t>(1, slots.size() - 1));
+    slots[(cursor + ticks) % slots.size()].push_back(std::move(session));
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <asio.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+class Session;
+
+struct HeartbeatConfig {
+    std::chrono::milliseconds pingInterval{30000};
+    std::chrono::milliseconds idleTimeout{90000};
+    std::chrono::milliseconds tick{1000};
+    size_t slots = 512;
+};
+
+// 哈希时间轮：所有会话共享一个 steady_timer，每个 tick 只检查当前槽位。
+// 会话只在读到数据时更新最后活跃时间（一次原子写），到期检查时再按剩余时间重新挂到新槽位，
+// 因此活跃会话不需要任何加锁或取消定时器的操作。
+class TimerWheel {
+public:
+    TimerWheel(asio::io_context& ioc, const HeartbeatConfig& config);
+    void start();
+    void stop();
+    // 线程安全，可在任意线程调用
+    void add(std::shared_ptr<Session> session);
+
+    static int64_t nowMs();
+private:
+    void schedule_tick();
+    void on_tick();
+    void insert(std::weak_ptr<Session> session, std::chrono::milliseconds delay);
+
+    HeartbeatConfig config;
+    asio::strand<asio::io_context::executor_type> strand;
+    asio::steady_timer timer;
+    std::vector<std::vector<std::weak_ptr<Session>>> slots;
+    size_t cursor = 0;
+    bool running = false;
+};
@@ -1,6 +1,24 @@
 #include "ConnectionPool.h"
 #include <soci/mysql/soci-mysql.h>
-#include <iostream>
+#include "telemetry/Metrics.h"
+#include "util/Logger.h"
+#include "telemetry/Tracer.h"
+
+namespace {
+    struct PoolMetrics {
+        Histogram& wait = MetricsRegistry::getInstance().histogram("chat_db_pool_wait_seconds",
+            "Time spent waiting for a pooled database connection", MetricsRegistry::latencyBucketsNs(), 1e9);
+        Histogram& hold = MetricsRegistry::getInstance().histogram("chat_db_connection_hold_seconds",
+            "Time a database connection stays checked out (query time)", MetricsRegistry::latencyBucketsNs(), 1e9);
+        Gauge& inUse = MetricsRegistry::getInstance().gauge("chat_db_connections_in_use", "Database connections checked out");
+        Gauge& idle = MetricsRegistry::getInstance().gauge("chat_db_connections_idle", "Database connections available in the pool");
+        Counter& replenished = MetricsRegistry::getInstance().counter("chat_db_connections_replenished_total", "Broken connections replaced");
+    };
+    PoolMetrics& poolMetrics() {
+        static PoolMetrics metrics;
+        return metrics;
+    }
+}
 
 std::unique_ptr<ConnectionPool> ConnectionPool::instance = nullptr;
 void ConnectionPool::initInstance(asio::io_context& ioc) {
@@ -16,7 +34,7 @@ ConnectionPool& ConnectionPool::getInstance(){
     return *instance;
 }
 void ConnectionPool::init(const std::string& connStr,int size){
-    std::unique_lock<std::mutex> lock(mtx);
+    LockGuard<PoolMutex> lock(mtx);
     if (!ConPool.empty()) {
         return;
     }
@@ -26,30 +44,45 @@ void ConnectionPool::init(const std::string& connStr,int size){
         auto connection=std::make_unique<soci::session>(soci::mysql,connectionString);
         ConPool.push_back(std::move(connection));
     }
-    std::cout << "Connection pool initialized with " << ConPool.size() << " connections." << std::endl;
+    poolMetrics().idle.set(static_cast<int64_t>(ConPool.size()));
+    LOG_INFO("connection_pool_initialized", "connections", ConPool.size());
 }
 std::unique_ptr<soci::session> ConnectionPool::getConnection(){
-    std::unique_lock<std::mutex> lock(mtx);
+    ScopedTimer timer(poolMetrics().wait);
+    TraceSpan span("db.pool_acquire");
+    LockGuard<PoolMutex> lock(mtx);
     cv.wait(lock,[this]{ return !ConPool.empty(); });
     auto connection=std::move(ConPool.back());
     ConPool.pop_back();
+    poolMetrics().inUse.add(1);
+    poolMetrics().idle.set(static_cast<int64_t>(ConPool.size()));
     return connection;
 }
 void ConnectionPool::returnConnection(std::unique_ptr<soci::session> conn){
-    std::unique_lock<std::mutex> lock(mtx);
+    LockGuard<PoolMutex> lock(mtx);
     ConPool.push_back(std::move(conn));
+    poolMetrics().idle.set(static_cast<int64_t>(ConPool.size()));
     lock.unlock();
     cv.notify_one();
 }
+void ConnectionPool::onConnectionReleased(std::chrono::steady_clock::time_point acquiredAt){
+    poolMetrics().inUse.sub(1);
+    poolMetrics().hold.observe(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - acquiredAt).count()));
+    // 连接从取出到归还的这段时间即仓储层查询耗时
+    Tracer::getInstance().emit("db.query",
+        std::chrono::duration_cast<std::chrono::microseconds>(acquiredAt.time_since_epoch()).count(), Tracer::nowUs());
+}
 void ConnectionPool::replenishConnectionAsync(){
     asio::post(io_context, [this]() {
         try {
             auto new_conn = std::make_unique<soci::session>(soci::mysql, connectionString);
             returnConnection(std::move(new_conn));
-            std::cout << "[ConnectionPool] A new connection has been replenished." << std::endl;
+            poolMetrics().replenished.inc();
+            LOG_INFO("connection_replenished");
         }
         catch (const std::exception& e) {
-            std::cerr << "[ConnectionPool] Failed to replenish connection: " << e.what() << std::endl;
+            LOG_ERROR("connection_replenish_failed", "error", e.what());
         }
     });
 }
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
+#include "telemetry/LockProfiler.h"
 class ConnectionPool {
 public:
     ~ConnectionPool()=default;
@@ -19,22 +21,24 @@ public:
     std::unique_ptr<soci::session> getConnection();
     void returnConnection(std::unique_ptr<soci::session> conn);
     void replenishConnectionAsync();
+    void onConnectionReleased(std::chrono::steady_clock::time_point acquiredAt);
 private:
     ConnectionPool(asio::io_context& ioc) : io_context(ioc) {}
     static std::unique_ptr<ConnectionPool> instance;
     std::vector<std::unique_ptr<soci::session>>ConPool;
-    std::mutex mtx;
+    PoolMutex mtx{"connection_pool"};
     asio::io_context& io_context;
-    std::condition_variable cv;
+    std::condition_variable_any cv; // 等待 LockGuard，剖析开启时底层不是 std::mutex
     std::string connectionString;
     int poolSize;
     
 };
 class ConnectionWrapper {
 public:
-    ConnectionWrapper(ConnectionPool* pool,std::unique_ptr<soci::session>conn):pool(pool),connection(std::move(conn)),is_valid(true){}
+    ConnectionWrapper(ConnectionPool* pool,std::unique_ptr<soci::session>conn):pool(pool),connection(std::move(conn)),is_valid(true),acquiredAt(std::chrono::steady_clock::now()){}
     ~ConnectionWrapper(){
         if(connection){
+            pool->onConnectionReleased(acquiredAt);
 			if (is_valid)
             {
                 pool->returnConnection(std::move(connection));
@@ -57,4 +61,5 @@ private:
     ConnectionPool* pool;
     std::unique_ptr<soci::session>connection;
     bool is_valid;
+    std::chrono::steady_clock::time_point acquiredAt;
 };
\ No newline at end of file
@@ -13,6 +13,10 @@ public:
     virtual std::vector<Message> findByRoomId(long long room_id) = 0;
     virtual std::vector<Message> findByContent(const std::string& content) = 0;
     virtual std::vector<Message> findLatestByRoomId(long long roomId, int limit) = 0;
+    // 房间中序号大于 afterSeq 的消息，按序号升序
+    virtual std::vector<Message> findByRoomIdAfterSequence(long long roomId, long long afterSeq, int limit) = 0;
+    // 房间已分配的最大序号，没有消息时为 0
+    virtual long long getLastSequence(long long roomId) = 0;
     virtual bool addMessage(Message& message) = 0;
     virtual bool removeMessage(long long id) = 0;
 };
@@ -0,0 +1,241 @@
+#include "InMemoryRepositories.h"
+#include <algorithm>
+
+std::optional<User> InMemoryUserRepository::findByUsername(const std::string& username) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = idsByUsername.find(username);
+    if (it == idsByUsername.end()) {
+        return std::nullopt;
+    }
+    return users.at(it->second);
+}
+std::optional<User> InMemoryUserRepository::findByUserId(long long id) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = users.find(id);
+    if (it == users.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+std::vector<User> InMemoryUserRepository::getAllUsers() {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<User> result;
+    result.reserve(users.size());
+    for (const auto& pair : users) {
+        result.push_back(pair.second);
+    }
+    return result;
+}
+bool InMemoryUserRepository::updateUser(User& user) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = users.find(user.getId());
+    if (it == users.end()) {
+        return false;
+    }
+    if (it->second.getUsername() != user.getUsername()) {
+        if (idsByUsername.count(user.getUsername())) {
+            return false;
+        }
+        idsByUsername.erase(it->second.getUsername());
+        idsByUsername[user.getUsername()] = user.getId();
+    }
+    it->second = user;
+    return true;
+}
+bool InMemoryUserRepository::addUser(User& user) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (idsByUsername.count(user.getUsername())) {
+        return false;
+    }
+    user.setId(nextId++);
+    user.setCreatedAt(std::chrono::system_clock::now());
+    idsByUsername[user.getUsername()] = user.getId();
+    users[user.getId()] = user;
+    return true;
+}
+bool InMemoryUserRepository::removeUser(long long id) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = users.find(id);
+    if (it == users.end()) {
+        return false;
+    }
+    idsByUsername.erase(it->second.getUsername());
+    users.erase(it);
+    return true;
+}
+
+std::optional<Room> InMemoryRoomRepository::findByRoomId(long long id) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = rooms.find(id);
+    if (it == rooms.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+std::optional<Room> InMemoryRoomRepository::findByRoomName(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = idsByName.find(name);
+    if (it == idsByName.end()) {
+        return std::nullopt;
+    }
+    return rooms.at(it->second);
+}
+std::optional<Room> InMemoryRoomRepository::findByCreatorId(long long creator_id) {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& pair : rooms) {
+        if (pair.second.getCreatorId() == creator_id) {
+            return pair.second;
+        }
+    }
+    return std::nullopt;
+}
+std::vector<Room> InMemoryRoomRepository::getAllRooms() {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<Room> result;
+    result.reserve(rooms.size());
+    for (const auto& pair : rooms) {
+        result.push_back(pair.second);
+    }
+    return result;
+}
+bool InMemoryRoomRepository::updateRoom(Room& room) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = rooms.find(room.getId());
+    if (it == rooms.end()) {
+        return false;
+    }
+    if (it->second.getName() != room.getName()) {
+        if (idsByName.count(room.getName())) {
+            return false;
+        }
+        idsByName.erase(it->second.getName());
+        idsByName[room.getName()] = room.getId();
+    }
+    it->second = room;
+    return true;
+}
+bool InMemoryRoomRepository::addRoom(Room& room) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (idsByName.count(room.getName())) {
+        return false;
+    }
+    room.setId(nextId++);
+    room.setCreatedAt(std::chrono::system_clock::now());
+    idsByName[room.getName()] = room.getId();
+    rooms[room.getId()] = room;
+    return true;
+}
+bool InMemoryRoomRepository::removeRoom(long long id) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = rooms.find(id);
+    if (it == rooms.end()) {
+        return false;
+    }
+    idsByName.erase(it->second.getName());
+    rooms.erase(it);
+    return true;
+}
+
+std::optional<Message> InMemoryMessageRepository::findByMessageId(long long id) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = messages.find(id);
+    if (it == messages.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+std::vector<Message> InMemoryMessageRepository::findBySenderId(long long sender_id) {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<Message> result;
+    for (const auto& pair : messages) {
+        if (pair.second.getSenderId() == sender_id) {
+            result.push_back(pair.second);
+        }
+    }
+    return result;
+}
+std::vector<Message> InMemoryMessageRepository::findByRoomId(long long room_id) {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<Message> result;
+    auto it = idsByRoom.find(room_id);
+    if (it != idsByRoom.end()) {
+        for (long long id : it->second) {
+            result.push_back(messages.at(id));
+        }
+    }
+    return result;
+}
+std::vector<Message> InMemoryMessageRepository::findByContent(const std::string& content) {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<Message> result;
+    for (const auto& pair : messages) {
+        if (pair.second.getContent().find(content) != std::string::npos) {
+            result.push_back(pair.second);
+        }
+    }
+    return result;
+}
+std::vector<Message> InMemoryMessageRepository::findLatestByRoomId(long long roomId, int limit) {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<Message> result;
+    auto it = idsByRoom.find(roomId);
+    if (it == idsByRoom.end()) {
+        return result;
+    }
+    // 与 MySQL 实现一致：最新的在前
+    const auto& ids = it->second;
+    for (auto rit = ids.rbegin(); rit != ids.rend() && static_cast<int>(result.size()) < limit; ++rit) {
+        result.push_back(messages.at(*rit));
+    }
+    return result;
+}
+std::vector<Message> InMemoryMessageRepository::findByRoomIdAfterSequence(long long roomId, long long afterSeq, int limit) {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<Message> result;
+    auto it = idsByRoom.find(roomId);
+    if (it == idsByRoom.end()) {
+        return result;
+    }
+    for (long long id : it->second) {
+        const Message& message = messages.at(id);
+        if (message.getRoomSeq() > afterSeq) {
+            result.push_back(message);
+        }
+    }
+    std::sort(result.begin(), result.end(),
+        [](const Message& a, const Message& b) { return a.getRoomSeq() < b.getRoomSeq(); });
+    if (static_cast<int>(result.size()) > limit) {
+        result.resize(limit);
+    }
+    return result;
+}
+long long InMemoryMessageRepository::getLastSequence(long long roomId) {
+    std::lock_guard<std::mutex> lock(mtx);
+    long long last = 0;
+    auto it = idsByRoom.find(roomId);
+    if (it != idsByRoom.end()) {
+        for (long long id : it->second) {
+            last = std::max(last, messages.at(id).getRoomSeq());
+        }
+    }
+    return last;
+}
+bool InMemoryMessageRepository::addMessage(Message& message) {
+    std::lock_guard<std::mutex> lock(mtx);
+    message.setId(nextId++);
+    message.setCreatedAt(std::chrono::system_clock::now());
+    messages[message.getId()] = message;
+    idsByRoom[message.getRoomId()].push_back(message.getId());
+    return true;
+}
+bool InMemoryMessageRepository::removeMessage(long long id) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = messages.find(id);
+    if (it == messages.end()) {
+        return false;
+    }
+    auto& ids = idsByRoom[it->second.getRoomId()];
+    ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+    messages.erase(it);
+    return true;
+}
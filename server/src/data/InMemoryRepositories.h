@@ -0,0 +1,60 @@
+#pragma once
+
+#include "IUserRepository.h"
+#include "IRoomRepository.h"
+#include "IMessageRepository.h"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 进程内的仓储实现，不依赖数据库，用于基准测试和无网络的模拟驱动
+
+class InMemoryUserRepository : public IUserRepository {
+public:
+    std::optional<User> findByUsername(const std::string& username) override;
+    std::optional<User> findByUserId(long long id) override;
+    std::vector<User> getAllUsers() override;
+    bool updateUser(User& user) override;
+    bool addUser(User& user) override;
+    bool removeUser(long long id) override;
+private:
+    std::mutex mtx;
+    long long nextId = 1;
+    std::unordered_map<long long, User> users;
+    std::unordered_map<std::string, long long> idsByUsername;
+};
+
+class InMemoryRoomRepository : public IRoomRepository {
+public:
+    std::optional<Room> findByRoomId(long long id) override;
+    std::optional<Room> findByRoomName(const std::string& name) override;
+    std::optional<Room> findByCreatorId(long long creator_id) override;
+    std::vector<Room> getAllRooms() override;
+    bool updateRoom(Room& room) override;
+    bool addRoom(Room& room) override;
+    bool removeRoom(long long id) override;
+private:
+    std::mutex mtx;
+    long long nextId = 1;
+    std::unordered_map<long long, Room> rooms;
+    std::unordered_map<std::string, long long> idsByName;
+};
+
+class InMemoryMessageRepository : public IMessageRepository {
+public:
+    std::optional<Message> findByMessageId(long long id) override;
+    std::vector<Message> findBySenderId(long long sender_id) override;
+    std::vector<Message> findByRoomId(long long room_id) override;
+    std::vector<Message> findByContent(const std::string& content) override;
+    std::vector<Message> findLatestByRoomId(long long roomId, int limit) override;
+    std::vector<Message> findByRoomIdAfterSequence(long long roomId, long long afterSeq, int limit) override;
+    long long getLastSequence(long long roomId) override;
+    bool addMessage(Message& message) override;
+    bool removeMessage(long long id) override;
+private:
+    std::mutex mtx;
+    long long nextId = 1;
+    std::unordered_map<long long, Message> messages;
+    std::unordered_map<long long, std::vector<long long>> idsByRoom; // 按插入顺序
+};
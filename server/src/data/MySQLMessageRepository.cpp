@@ -1,6 +1,7 @@
 ﻿#include "MySQLMessageRepository.h"
 #include "ConnectionPool.h"
 #include "DataAccess.h"
+#include "util/Logger.h"
 #include <iostream>
 #include <set>
 
@@ -10,9 +11,10 @@ bool MySQLMessageRepository::addMessage(Message& msg){
     try{
         soci::session& sql = *conWrapper;
         soci::transaction tr(sql);
-        sql << "INSERT INTO messages (room_id, sender_id, content) VALUES (:room_id, :sender_id, :content)",
+        sql << "INSERT INTO messages (room_id, sender_id, room_seq, content) VALUES (:room_id, :sender_id, :room_seq, :content)",
             soci::use(msg.getRoomId(), "room_id"),
             soci::use(msg.getSenderId(), "sender_id"),
+            soci::use(msg.getRoomSeq(), "room_seq"),
             soci::use(msg.getContent(), "content");
         long long newId;
         if (!sql.get_last_insert_id("messages", newId)) {
@@ -34,7 +36,7 @@ bool MySQLMessageRepository::addMessage(Message& msg){
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found." << std::endl;
+            LOG_DEBUG("query_no_data");
             return false; 
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -72,7 +74,7 @@ bool MySQLMessageRepository::removeMessage(long long id){
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found." << std::endl;
+            LOG_DEBUG("query_no_data");
             return false;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -125,18 +127,18 @@ std::optional<Message> MySQLMessageRepository::findByMessageId(long long id){
             else {
                 msg.setCreatedAt(std::chrono::system_clock::now());
             }
-            std::cout << "[DEBUG] MessageRepository: Message found. ID: " << msg.getId() << std::endl;
+            LOG_DEBUG("message_found", "message_id", msg.getId());
             return msg;
         }
         else {
-            std::cout << "[DEBUG] MessageRepository: message not found in database." << std::endl;
+            LOG_DEBUG("message_not_found");
             return std::nullopt;
         }
     }
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return std::nullopt;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -209,7 +211,7 @@ std::vector<Message> MySQLMessageRepository::findBySenderId(long long sender_id)
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             messages.clear();
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -285,7 +287,7 @@ std::vector<Message> MySQLMessageRepository::findByRoomId(long long room_id) {
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             messages.clear();
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -359,7 +361,7 @@ std::vector<Message> MySQLMessageRepository::findByContent(const std::string& co
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             messages.clear();
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -393,13 +395,13 @@ std::vector<Message> MySQLMessageRepository::findLatestByRoomId(long long room_i
         
         soci::session& sql = *conWrapper;
 
-        long long id_val, room_id_val, sender_id_val;
+        long long id_val, room_id_val, sender_id_val, room_seq_val;
         std::string content_val;
         std::tm created_at_tm = {};
-        soci::indicator id_ind, room_id_ind, sender_id_ind, content_ind, created_at_ind;
+        soci::indicator id_ind, room_id_ind, sender_id_ind, room_seq_ind, content_ind, created_at_ind;
 
         soci::statement st = (sql.prepare <<
-            "SELECT id, room_id, sender_id, content, created_at "
+            "SELECT id, room_id, sender_id, room_seq, content, created_at "
             "FROM messages WHERE room_id = :room_id "
             "ORDER BY created_at DESC LIMIT :limitValue",
             soci::use(room_id, "room_id"),
@@ -407,6 +409,7 @@ std::vector<Message> MySQLMessageRepository::findLatestByRoomId(long long room_i
             soci::into(id_val, id_ind),
             soci::into(room_id_val, room_id_ind),
             soci::into(sender_id_val, sender_id_ind),
+            soci::into(room_seq_val, room_seq_ind),
             soci::into(content_val, content_ind),
             soci::into(created_at_tm, created_at_ind));
 
@@ -417,6 +420,7 @@ std::vector<Message> MySQLMessageRepository::findLatestByRoomId(long long room_i
             msg.setId(id_val);
             msg.setRoomId(room_id_val);
             msg.setSenderId(sender_id_val);
+            msg.setRoomSeq(room_seq_ind == soci::i_ok ? room_seq_val : 0);
             msg.setContent(content_val);
 
             if (created_at_ind == soci::i_ok) {
@@ -438,7 +442,7 @@ std::vector<Message> MySQLMessageRepository::findLatestByRoomId(long long room_i
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             messages.clear();
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -465,6 +469,129 @@ std::vector<Message> MySQLMessageRepository::findLatestByRoomId(long long room_i
 
     return messages;
 }
+std::vector<Message> MySQLMessageRepository::findByRoomIdAfterSequence(long long room_id, long long afterSeq, int limit) {
+    std::vector<Message> messages;
+    auto conWrapper = ConnectionWrapper(&ConnectionPool::getInstance(),
+        ConnectionPool::getInstance().getConnection());
+    try {
+        
+        soci::session& sql = *conWrapper;
+
+        long long id_val, room_id_val, sender_id_val, room_seq_val;
+        std::string content_val;
+        std::tm created_at_tm = {};
+        soci::indicator id_ind, room_id_ind, sender_id_ind, room_seq_ind, content_ind, created_at_ind;
+
+        soci::statement st = (sql.prepare <<
+            "SELECT id, room_id, sender_id, room_seq, content, created_at "
+            "FROM messages WHERE room_id = :room_id AND room_seq > :afterSeq "
+            "ORDER BY room_seq ASC LIMIT :limitValue",
+            soci::use(room_id, "room_id"),
+            soci::use(afterSeq, "afterSeq"),
+            soci::use(limit, "limitValue"),
+            soci::into(id_val, id_ind),
+            soci::into(room_id_val, room_id_ind),
+            soci::into(sender_id_val, sender_id_ind),
+            soci::into(room_seq_val, room_seq_ind),
+            soci::into(content_val, content_ind),
+            soci::into(created_at_tm, created_at_ind));
+
+        st.execute();
 
+        while (st.fetch()) {
+            Message msg;
+            msg.setId(id_val);
+            msg.setRoomId(room_id_val);
+            msg.setSenderId(sender_id_val);
+            msg.setRoomSeq(room_seq_ind == soci::i_ok ? room_seq_val : 0);
+            msg.setContent(content_val);
 
+            if (created_at_ind == soci::i_ok) {
+                std::time_t tt = std::mktime(&created_at_tm);
+                if (tt != -1) {
+                    msg.setCreatedAt(std::chrono::system_clock::from_time_t(tt));
+                }
+                else {
+                    msg.setCreatedAt(std::chrono::system_clock::now());
+                }
+            }
+            else {
+                msg.setCreatedAt(std::chrono::system_clock::now());
+            }
 
+            messages.push_back(msg);
+        }
+    }
+    catch (const soci::soci_error& e) {
+        soci::soci_error::error_category category = e.get_error_category();
+        if (category == soci::soci_error::error_category::no_data) {
+            LOG_DEBUG("query_no_data");
+            messages.clear();
+        }
+        else if (category == soci::soci_error::error_category::connection_error) {
+            std::cerr << "[ERROR] Connection error: " << e.what() << std::endl;
+            conWrapper.markAsInvalid();
+            messages.clear();
+        }
+        else if (category == soci::soci_error::error_category::system_error) {
+            std::cerr << "[ERROR] System/Driver error: " << e.what() << std::endl;
+            conWrapper.markAsInvalid();
+            messages.clear();
+        }
+        else {
+            std::cerr << "[ERROR] Database operation error: " << e.what()
+                << " (Category: " << category << ")" << std::endl;
+            throw;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[ERROR] Unexpected standard exception: " << e.what() << std::endl;
+        conWrapper.markAsInvalid();
+        messages.clear();
+    }
+
+    return messages;
+}
+long long MySQLMessageRepository::getLastSequence(long long room_id) {
+    long long lastSeq = 0;
+    auto conWrapper = ConnectionWrapper(&ConnectionPool::getInstance(),
+        ConnectionPool::getInstance().getConnection());
+    try {
+        soci::session& sql = *conWrapper;
+        soci::indicator last_seq_ind;
+        sql << "SELECT MAX(room_seq) FROM messages WHERE room_id = :room_id",
+            soci::use(room_id, "room_id"),
+            soci::into(lastSeq, last_seq_ind);
+        if (last_seq_ind != soci::i_ok) {
+            lastSeq = 0;
+        }
+    }
+    catch (const soci::soci_error& e) {
+        soci::soci_error::error_category category = e.get_error_category();
+        if (category == soci::soci_error::error_category::no_data) {
+            LOG_DEBUG("query_no_data");
+            lastSeq = 0;
+        }
+        else if (category == soci::soci_error::error_category::connection_error) {
+            std::cerr << "[ERROR] Connection error: " << e.what() << std::endl;
+            conWrapper.markAsInvalid();
+            lastSeq = 0;
+        }
+        else if (category == soci::soci_error::error_category::system_error) {
+            std::cerr << "[ERROR] System/Driver error: " << e.what() << std::endl;
+            conWrapper.markAsInvalid();
+            lastSeq = 0;
+        }
+        else {
+            std::cerr << "[ERROR] Database operation error: " << e.what()
+                << " (Category: " << category << ")" << std::endl;
+            throw;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[ERROR] Unexpected standard exception: " << e.what() << std::endl;
+        conWrapper.markAsInvalid();
+        lastSeq = 0;
+    }
+    return lastSeq;
+}
@@ -12,6 +12,8 @@ public:
     std::vector<Message> findByRoomId(long long room_id);
     std::vector<Message> findByContent(const std::string& content);
     std::vector<Message> findLatestByRoomId(long long roomId, int limit);
+    std::vector<Message> findByRoomIdAfterSequence(long long roomId, long long afterSeq, int limit);
+    long long getLastSequence(long long roomId);
     bool addMessage(Message& message);
     bool removeMessage(long long id);
 };
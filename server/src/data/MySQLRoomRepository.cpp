@@ -1,6 +1,7 @@
 #include "MySQLRoomRepository.h"
 #include "ConnectionPool.h"
 #include "DataAccess.h"
+#include "util/Logger.h"
 #include <iostream>
 
 std::optional<Room> MySQLRoomRepository::findByRoomId(long long id){
@@ -31,17 +32,16 @@ std::optional<Room> MySQLRoomRepository::findByRoomId(long long id){
             else {
                 room.setCreatedAt(std::chrono::system_clock::now());
             }
-            std::cout << "[DEBUG] RoomRepository: Room found. Name: '" << room.getName()
-                << "', ID: " << room.getId() << std::endl;
+            LOG_DEBUG("room_found", "room", room.getName(), "room_id", room.getId());
             return room;
         }
-        std::cout << "[DEBUG] RoomRepository: Room not found." << std::endl;
+        LOG_DEBUG("room_not_found");
         return std::nullopt;
     }
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return std::nullopt;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -93,18 +93,17 @@ std::optional<Room> MySQLRoomRepository::findByRoomName(const std::string& name)
             else {
                 room.setCreatedAt(std::chrono::system_clock::now());
             }
-            std::cout << "[DEBUG] RoomRepository: Room found. Name: '" << room.getName()
-                << "', ID: " << room.getId() << std::endl;
+            LOG_DEBUG("room_found", "room", room.getName(), "room_id", room.getId());
             return room;
         }
-        std::cout << "[DEBUG] RoomRepository: Room not found." << std::endl;
+        LOG_DEBUG("room_not_found");
         return std::nullopt;
 
     }
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return std::nullopt;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -156,17 +155,16 @@ std::optional<Room> MySQLRoomRepository::findByCreatorId(long long creatorid){
             else {
                 room.setCreatedAt(std::chrono::system_clock::now());
             }
-            std::cout << "[DEBUG] RoomRepository: Room found. Name: '" << room.getName()
-                << "', ID: " << room.getId() << std::endl;
+            LOG_DEBUG("room_found", "room", room.getName(), "room_id", room.getId());
             return room;
         }
-        std::cout << "[DEBUG] RoomRepository: Room not found." << std::endl;
+        LOG_DEBUG("room_not_found");
         return std::nullopt;
     }
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return std::nullopt;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -239,7 +237,7 @@ std::vector<Room> MySQLRoomRepository::getAllRooms() {
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             rooms.clear();
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -293,7 +291,7 @@ bool MySQLRoomRepository::updateRoom(Room& room){
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return false;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -358,7 +356,7 @@ bool MySQLRoomRepository::addRoom(Room& room){
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return false;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -396,7 +394,7 @@ bool MySQLRoomRepository::removeRoom(long long id){
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return false;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
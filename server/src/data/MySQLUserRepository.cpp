@@ -1,6 +1,7 @@
 #include "MySQLUserRepository.h"
 #include "ConnectionPool.h"
 #include "DataAccess.h"
+#include "util/Logger.h"
 #include <iostream>
 #include <vector>
 #include <optional>
@@ -38,17 +39,17 @@ std::optional<User> MySQLUserRepository::findByUsername(const std::string& usern
                 user.setCreatedAt(std::chrono::system_clock::now());
             }
 
-            std::cout << "[DEBUG] UserRepository: User found with ID: " << user.getId() << std::endl;
+            LOG_DEBUG("user_found", "user_id", user.getId());
             return user;
         }
 
-        std::cout << "[DEBUG] UserRepository: User not found." << std::endl;
+        LOG_DEBUG("user_not_found");
         return std::nullopt;
     }
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return std::nullopt;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -105,16 +106,16 @@ std::optional<User> MySQLUserRepository::findByUserId(long long id){
             else {
                 user.setCreatedAt(std::chrono::system_clock::now());
             }
-            std::cout << "[DEBUG] UserRepository: User found with ID: " << user.getId() << std::endl;
+            LOG_DEBUG("user_found", "user_id", user.getId());
             return user;
         }
-        std::cout << "[DEBUG] UserRepository: User not found." << std::endl;
+        LOG_DEBUG("user_not_found");
         return std::nullopt;
     }
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return std::nullopt;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -188,7 +189,7 @@ std::vector<User> MySQLUserRepository::getAllUsers() {
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             users.clear();
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -238,7 +239,7 @@ bool MySQLUserRepository::updateUser(User& user){
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return false;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -292,7 +293,7 @@ bool MySQLUserRepository::addUser(User& user){
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return false;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -334,7 +335,7 @@ bool MySQLUserRepository::removeUser(long long id){
     catch (const soci::soci_error& e) {
         soci::soci_error::error_category category = e.get_error_category();
         if (category == soci::soci_error::error_category::no_data) {
-            std::cout << "[DEBUG] No data found for query." << std::endl;
+            LOG_DEBUG("query_no_data");
             return false;
         }
         else if (category == soci::soci_error::error_category::connection_error) {
@@ -1,6 +1,16 @@
 #include "util/ConfigManager.h"
+#include "util/Logger.h"
 #include "data/ConnectionPool.h"
 #include "core/Server.h"
+#include "service/RoomService.h"
+#include "session/OutboundFrame.h"
+#include "session/OutboundQueue.h"
+#include "codec/ZstdCompressor.h"
+#include "telemetry/LockProfiler.h"
+#include "telemetry/Metrics.h"
+#include "telemetry/MetricsHttpServer.h"
+#include "telemetry/Tracer.h"
+#include "telemetry/TrafficCapture.h"
 #include <iostream>
 
 int main() {
@@ -9,6 +19,9 @@ int main() {
     }
     try {
         const auto& config = ConfigManager::getInstance().getConfig();
+        const json logging_config = config.value("logging", json::object());
+        Logger::getInstance().start(logging_config.value("file", ""),
+            Logger::parseLevel(logging_config.value("level", "info")));
         const auto& db_config = config.at("database");
         std::string conn_str = 
         "db=" + db_config.at("dbname").get<std::string>() + " " +
@@ -20,25 +33,105 @@ int main() {
         asio::io_context io_context;
 		ConnectionPool::initInstance(io_context);
         ConnectionPool::getInstance().init(conn_str, 10);
+        const json compression_config = config.value("compression", json::object());
+        if (compression_config.value("enabled", false)) {
+            auto compressor = std::make_shared<ZstdCompressor>(compression_config.value("level", 3));
+            const std::string dictionary = compression_config.value("dictionary", "");
+            if (!dictionary.empty() && !compressor->loadDictionary(dictionary)) {
+                LOG_WARN("compression_dictionary_missing", "path", dictionary);
+            }
+            OutboundFrame::configureCompression(compressor, compression_config.value("min_size", 128));
+            LOG_INFO("compression_enabled", "dictionary_id", compressor->getDictionaryId());
+        }
+        const json outbound_config = config.value("outbound", json::object());
+        OutboundLimits limits;
+        limits.maxQueuedBytes = outbound_config.value("max_queued_bytes", limits.maxQueuedBytes);
+        limits.maxQueuedFrames = outbound_config.value("max_queued_frames", limits.maxQueuedFrames);
+        limits.globalBudgetBytes = outbound_config.value("global_budget_bytes", limits.globalBudgetBytes);
+        limits.policy = OutboundQueue::parsePolicy(outbound_config.value("policy", "drop_oldest"));
+        limits.flushWindowUs = outbound_config.value("flush_window_us", limits.flushWindowUs);
+        limits.flushMaxBytes = outbound_config.value("flush_max_bytes", limits.flushMaxBytes);
+        limits.flushMaxFrames = outbound_config.value("flush_max_frames", limits.flushMaxFrames);
+        OutboundQueue::configure(limits);
         auto work_guard = asio::make_work_guard(io_context.get_executor());
         unsigned short port = config.at("server").at("port").get<unsigned short>();
         Server server(io_context, port);
+        server.setStrandPoolSize(config.at("server").value("strand_pool_size", 1024));
         server.run();
+        server.startStatsReport(std::chrono::seconds(outbound_config.value("stats_interval_seconds", 60)));
         unsigned int thread_count = config.at("server").value("threads", 0);
+        const json tracing_config = config.value("tracing", json::object());
+        Tracer::getInstance().configure(tracing_config.value("sample_rate", 0.0), tracing_config.value("capacity", 65536));
+        const json capture_config = config.value("capture", json::object());
+        const std::string capture_file = capture_config.value("file", "");
+        if (!capture_file.empty()) {
+            TrafficCapture::getInstance().start(capture_file, capture_config.value("max_mb", 1024ull) * 1024 * 1024);
+        }
+        const json metrics_config = config.value("metrics", json::object());
+        std::unique_ptr<MetricsHttpServer> metrics_server;
+        if (metrics_config.value("enabled", true)) {
+            MetricsRegistry::getInstance().registerProcessMetrics();
+            MetricsRegistry::getInstance().counterCallback("chat_log_records_dropped_total", "Log records dropped because a thread's log buffer was full",
+                []() { return static_cast<double>(Logger::getInstance().getDroppedCount()); });
+            metrics_server = std::make_unique<MetricsHttpServer>(io_context,
+                metrics_config.value("address", "127.0.0.1"),
+                metrics_config.value("port", static_cast<unsigned short>(12346)));
+            metrics_server->addRoute("/trace", "application/json", []() {
+                return Tracer::getInstance().renderChromeJson();
+            });
+            metrics_server->addRoute("/locks", "text/plain", []() {
+                return LockProfiler::getInstance().renderReport();
+            });
+            metrics_server->start();
+        }
+        const json monitoring_config = config.value("monitoring", json::object());
+        if (monitoring_config.value("lag_probe_interval_ms", 100) > 0) {
+            LagMonitorConfig lag;
+            lag.interval = std::chrono::milliseconds(monitoring_config.value("lag_probe_interval_ms", 100));
+            lag.warnThreshold = std::chrono::milliseconds(monitoring_config.value("lag_warn_ms", 50));
+            server.enableLagMonitor(lag);
+        }
+        server.setHandlerBudget(std::chrono::milliseconds(monitoring_config.value("handler_budget_ms", 20)));
+        const json presence_config = config.value("presence", json::object());
+        PresenceConfig presence;
+        presence.window = std::chrono::milliseconds(presence_config.value("window_ms", 200));
+        presence.countOnlyThreshold = presence_config.value("count_only_threshold", 1000);
+        server.enablePresenceBatching(presence);
+        const json snapshot_config = config.value("snapshot", json::object());
+        RoomSnapshotConfig snapshot;
+        snapshot.ttl = std::chrono::milliseconds(snapshot_config.value("ttl_ms", 1000));
+        snapshot.maxMembers = snapshot_config.value("max_members", snapshot.maxMembers);
+        snapshot.recentMessages = snapshot_config.value("recent_messages", snapshot.recentMessages);
+        server.setRoomSnapshotConfig(snapshot);
+        const json ephemeral_config = config.value("ephemeral", json::object());
+        server.setEphemeralInterval(std::chrono::milliseconds(ephemeral_config.value("min_interval_ms", 500)));
+        const json heartbeat_config = config.value("heartbeat", json::object());
+        if (heartbeat_config.value("enabled", true)) {
+            HeartbeatConfig heartbeat;
+            heartbeat.pingInterval = std::chrono::milliseconds(heartbeat_config.value("ping_interval_ms", 30000));
+            heartbeat.idleTimeout = std::chrono::milliseconds(heartbeat_config.value("idle_timeout_ms", 90000));
+            heartbeat.tick = std::chrono::milliseconds(heartbeat_config.value("tick_ms", 1000));
+            heartbeat.slots = heartbeat_config.value("slots", 512);
+            server.enableHeartbeat(heartbeat, thread_count + 1);
+        }
         std::vector<std::thread> threads;
         for (int i = 0; i < thread_count; ++i) {
             threads.emplace_back([&io_context]() {
                 try {
                     io_context.run();
                 } catch (const std::exception& e) {
-                    std::cerr << "Thread exception: " << e.what() << std::endl;
+                    LOG_ERROR("io_thread_exception", "error", e.what());
                 }
             });
         }
 
         asio::signal_set signals(io_context, SIGINT, SIGTERM);
         signals.async_wait([&](const asio::error_code&, int) {
-            std::cout << "\n[INFO] Shutdown signal received. Stopping server..." << std::endl;
+            LOG_INFO("shutdown_requested");
+            server.stop();
+            if (metrics_server) {
+                metrics_server->stop();
+            }
             work_guard.reset();
         });
 
@@ -58,6 +151,8 @@ int main() {
         std::cerr << "Unexpected Error: " << e.what() << std::endl;
         return 1;
     }
-    std::cout << "[INFO] Server has shut down gracefully." << std::endl;
+    TrafficCapture::getInstance().stop();
+    LOG_INFO("server_stopped");
+    Logger::getInstance().stop();
     return 0;
 }
\ No newline at end of file
@@ -1,9 +1,27 @@
 #include "AuthService.h"
+#include "telemetry/Metrics.h"
+#include "util/Logger.h"
+
+namespace {
+    struct AuthMetrics {
+        Counter& loginSuccess = MetricsRegistry::getInstance().counter("chat_auth_logins_total", "Login attempts", "result=\"success\"");
+        Counter& loginFailure = MetricsRegistry::getInstance().counter("chat_auth_logins_total", "Login attempts", "result=\"failure\"");
+        Counter& registerSuccess = MetricsRegistry::getInstance().counter("chat_auth_registrations_total", "Registration attempts", "result=\"success\"");
+        Counter& registerFailure = MetricsRegistry::getInstance().counter("chat_auth_registrations_total", "Registration attempts", "result=\"failure\"");
+        Histogram& hashDuration = MetricsRegistry::getInstance().histogram("chat_auth_password_hash_seconds",
+            "Time spent hashing passwords", MetricsRegistry::latencyBucketsNs(), 1e9);
+    };
+    AuthMetrics& authMetrics() {
+        static AuthMetrics metrics;
+        return metrics;
+    }
+}
 
 void AuthService::handleLogin(std::shared_ptr<Session> session, const chat::LoginRequest& loginRequest){
     chat::Envelope response_envelope;
     auto userOpt = userRepository->findByUsername(loginRequest.username());
     if(!userOpt) {
+        authMetrics().loginFailure.inc();
         auto* err_resp = response_envelope.mutable_error_response();
         err_resp->set_error_message("User not found.");
         session->send(response_envelope);
@@ -12,7 +30,11 @@ void AuthService::handleLogin(std::shared_ptr<Session> session, const chat::Logi
     User user = *userOpt;
     const std::string& stored_salt = user.getSalt();
     const std::string& stored_hash = user.getHashedPassword();
-    const std::string& new_hash_attempt = Crypto::hashPassword(loginRequest.password(), stored_salt);
+    std::string new_hash_attempt;
+    {
+        ScopedTimer timer(authMetrics().hashDuration);
+        new_hash_attempt = Crypto::hashPassword(loginRequest.password(), stored_salt);
+    }
     //std::cout << "\n\n======= HASH COMPARISON DIAGNOSTICS =======" << std::endl;
     //Crypto::print_string_details("Stored Hash (from DB)", stored_hash);
     //Crypto::print_string_details("New Hash (just generated)", new_hash_attempt);
@@ -20,7 +42,8 @@ void AuthService::handleLogin(std::shared_ptr<Session> session, const chat::Logi
     //// ========================================================
 
     if (new_hash_attempt == stored_hash) {
-        std::cout << "Password verification SUCCESSFUL." << std::endl;
+        authMetrics().loginSuccess.inc();
+        LOG_DEBUG("password_verified", "user_id", user.getId());
         sessionManager->registerAuthenticatedSession(session, user.getId(), user.getUsername());
 
         auto* login_resp = response_envelope.mutable_login_response();
@@ -30,6 +53,7 @@ void AuthService::handleLogin(std::shared_ptr<Session> session, const chat::Logi
         session->send(response_envelope);
     }
     else{
+        authMetrics().loginFailure.inc();
         auto* err_resp = response_envelope.mutable_error_response();
         err_resp->set_error_message("Password incorrect.");
         session->send(response_envelope);
@@ -38,6 +62,7 @@ void AuthService::handleLogin(std::shared_ptr<Session> session, const chat::Logi
 void AuthService::handleRegister(std::shared_ptr<Session> session, const chat::RegistrationRequest& registrationRequest){
 	chat::Envelope response_envelope;
     if(userRepository->findByUsername(registrationRequest.username())){
+        authMetrics().registerFailure.inc();
         auto* err_resp = response_envelope.mutable_error_response();
         err_resp->set_error_message("Username already taken.");
         session->send(response_envelope);
@@ -54,13 +79,15 @@ void AuthService::handleRegister(std::shared_ptr<Session> session, const chat::R
     Crypto::print_string_details("generated", hashedPassword);
     Crypto::print_string_details("get", newUser.getHashedPassword());*/
     if (userRepository->addUser(newUser)) {
+        authMetrics().registerSuccess.inc();
         auto* reg_resp = response_envelope.mutable_registration_response();
         reg_resp->set_success(true);
         reg_resp->set_message("Registration successful. You can now log in, " + newUser.getUsername() + "!");
         session->send(response_envelope);
     }
     else {
-        // ---  create  falseʧӦ ---
+        // --- 如果 create 返回 false，发送失败响应 ---
+        authMetrics().registerFailure.inc();
         auto* response = response_envelope.mutable_registration_response();
         response->set_success(false);
         response->set_message("Registration failed due to a server-side error.");
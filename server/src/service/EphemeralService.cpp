@@ -0,0 +1,126 @@
+#include "EphemeralService.h"
+#include "core/TimerWheel.h"
+#include "telemetry/Metrics.h"
+#include "util/Logger.h"
+
+namespace {
+    struct EphemeralMetrics {
+        Counter& forwarded = MetricsRegistry::getInstance().counter("chat_ephemeral_signals_total", "Ephemeral signals", "result=\"forwarded\"");
+        Counter& coalesced = MetricsRegistry::getInstance().counter("chat_ephemeral_signals_total", "Ephemeral signals", "result=\"coalesced\"");
+        Counter& trailing = MetricsRegistry::getInstance().counter("chat_ephemeral_signals_total", "Ephemeral signals", "result=\"trailing\"");
+    };
+    EphemeralMetrics& ephemeralMetrics() {
+        static EphemeralMetrics metrics;
+        return metrics;
+    }
+}
+void EphemeralService::setMinInterval(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(gateMutex);
+    minIntervalMs = interval.count();
+}
+void EphemeralService::handleSignal(std::shared_ptr<Session> session, const chat::EphemeralSignal& signal) {
+    if (!session || !session->isAuthenticated()) {
+        return;
+    }
+    const long long senderId = session->getUserId();
+    const RoomRef room = signal.room_name().empty()
+        ? roomService->getUserRoom(senderId)
+        : roomService->getUserRoom(senderId, signal.room_name());
+    if (!room) {
+        // 短暂信号不回错误，避免客户端的高频信号换来同样频繁的错误响应
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        if (minIntervalMs > 0 && !stopped) {
+            const int64_t now = TimerWheel::nowMs();
+            Gate& gate = gates[GateKey(session->getSessionId(), room.slot, room.generation)];
+            if (signal.kind() == chat::EphemeralKind::STOPPED_TYPING) {
+                // 停止输入立即放行，窗口内更早压下的输入中信号已经过时
+                gate.hasPending = false;
+            } else if (gate.lastForwardMs != 0 && now - gate.lastForwardMs < minIntervalMs) {
+                if (gate.hasPending) {
+                    ephemeralMetrics().coalesced.inc();
+                }
+                gate.hasPending = true;
+                gate.pending = signal;
+                gate.session = session;
+                gate.room = room;
+                armTimerLocked();
+                return;
+            } else {
+                gate.lastForwardMs = now;
+            }
+            armTimerLocked();
+        }
+    }
+    forward(session, room, signal);
+}
+void EphemeralService::stop() {
+    std::lock_guard<std::mutex> lock(gateMutex);
+    stopped = true;
+    gates.clear();
+    trailingTimer.cancel();
+}
+void EphemeralService::forward(const std::shared_ptr<Session>& session, const RoomRef& room, const chat::EphemeralSignal& signal) {
+    chat::Envelope envelope;
+    auto* out = envelope.mutable_ephemeral_signal();
+    out->set_kind(signal.kind());
+    out->set_room_name(room.name);
+    out->set_from_user_id(std::to_string(session->getUserId()));
+    out->set_from_username(session->getUsername());
+    out->set_client_timestamp_us(signal.client_timestamp_us());
+    ephemeralMetrics().forwarded.inc();
+    roomService->broadcastToRoom(room, envelope, session->getUserId());
+}
+void EphemeralService::armTimerLocked() {
+    if (timerArmed || gates.empty()) {
+        return;
+    }
+    timerArmed = true;
+    // 每个窗口扫一次门表：补发到期的信号，回收窗口已过的空闲门
+    trailingTimer.expires_after(std::chrono::milliseconds(minIntervalMs));
+    trailingTimer.async_wait([this](const asio::error_code& ec) {
+        if (!ec) {
+            flushTrailing();
+        }
+    });
+}
+void EphemeralService::flushTrailing() {
+    std::vector<std::tuple<std::shared_ptr<Session>, RoomRef, chat::EphemeralSignal>> due;
+    {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        timerArmed = false;
+        if (stopped) {
+            return;
+        }
+        const int64_t now = TimerWheel::nowMs();
+        for (auto it = gates.begin(); it != gates.end();) {
+            Gate& gate = it->second;
+            if (now - gate.lastForwardMs < minIntervalMs) {
+                ++it;
+                continue;
+            }
+            std::shared_ptr<Session> session = gate.hasPending ? gate.session.lock() : nullptr;
+            if (!session || session->isClosed()) {
+                it = gates.erase(it);
+                continue;
+            }
+            due.emplace_back(std::move(session), gate.room, std::move(gate.pending));
+            gate.hasPending = false;
+            gate.session.reset();
+            gate.lastForwardMs = now;
+            ++it;
+        }
+        armTimerLocked();
+    }
+    for (const auto& [session, room, signal] : due) {
+        // 窗口内已离开房间的不再补发
+        const RoomRef current = roomService->getUserRoom(session->getUserId(), room.name);
+        if (current.slot != room.slot || current.generation != room.generation) {
+            continue;
+        }
+        ephemeralMetrics().trailing.inc();
+        forward(session, room, signal);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include "chat.pb.h"
+#include "session/Session.h"
+#include "RoomService.h"
+
+// 输入中等短暂信号：不经过 MessageService，不落库也不分配序号，直接交给房间扇出
+class EphemeralService {
+public:
+    EphemeralService(asio::io_context& ioc, RoomService* roomService) : roomService(roomService), trailingTimer(ioc) {}
+    // 同一会话在同一房间两次放行之间至少间隔 interval。期间到达的信号只保留最新一条，
+    // 窗口结束时补发，接收方看到的最终状态总与发送方一致；STOPPED_TYPING 不受限
+    void setMinInterval(std::chrono::milliseconds interval);
+    void handleSignal(std::shared_ptr<Session> session, const chat::EphemeralSignal& signal);
+    void stop();
+private:
+    // 键为 (会话 ID, 房间槽位, 房间代数)
+    using GateKey = std::tuple<uint64_t, uint32_t, uint32_t>;
+    struct Gate {
+        int64_t lastForwardMs = 0;
+        bool hasPending = false;
+        chat::EphemeralSignal pending;   // 窗口内被压下的最新信号
+        std::weak_ptr<Session> session;
+        RoomRef room;
+    };
+    void forward(const std::shared_ptr<Session>& session, const RoomRef& room, const chat::EphemeralSignal& signal);
+    // 需持有 gateMutex；门表非空时保持定时器运行
+    void armTimerLocked();
+    void flushTrailing();
+
+    RoomService* roomService;
+    int64_t minIntervalMs = 500;
+    std::mutex gateMutex;   // 多个 io 线程可能同时处理同一会话的请求
+    std::map<GateKey, Gate> gates;
+    asio::steady_timer trailingTimer;
+    bool timerArmed = false;
+    bool stopped = false;
+};
@@ -1,43 +1,79 @@
 #include "MessageService.h"
+#include "telemetry/Metrics.h"
+#include "util/Logger.h"
+
+namespace {
+    struct MessageMetrics {
+        Counter& publicMessages = MetricsRegistry::getInstance().counter("chat_messages_total", "Chat messages handled", "kind=\"public\"");
+        Counter& privateMessages = MetricsRegistry::getInstance().counter("chat_messages_total", "Chat messages handled", "kind=\"private\"");
+        Histogram& persistDuration = MetricsRegistry::getInstance().histogram("chat_message_persist_seconds",
+            "Time spent storing a public message", MetricsRegistry::latencyBucketsNs(), 1e9);
+    };
+    MessageMetrics& messageMetrics() {
+        static MessageMetrics metrics;
+        return metrics;
+    }
+}
 void MessageService::handlePublicMessage(std::shared_ptr<Session> session, const chat::PublicMessage& publicMessage) {
     chat::Envelope response;
     if (!session || !session->isAuthenticated()) {
-        std::cerr << "Warning: Unauthenticated session tried to send a public message." << std::endl;
+        LOG_WARN("unauthenticated_public_message");
         return;
     }
     const long long senderId = session->getUserId();
-    const std::string roomName = roomService->getUserCurrentRoomName(senderId);
+    // 一次查询得到房间引用，后续持久化与广播都不再按名字查找
+    const RoomRef room = publicMessage.room_name().empty()
+        ? roomService->getUserRoom(senderId)
+        : roomService->getUserRoom(senderId, publicMessage.room_name());
 
-    if (roomName.empty()) {
-        std::cerr << "Warning: User " << session->getUsername() 
-                  << " (ID: " << senderId 
-                  << ") tried to send a message without being in a room." << std::endl;
+    if (!room) {
+        LOG_WARN("public_message_without_room", "user_id", senderId, "room", publicMessage.room_name());
         auto* error_response = response.mutable_error_response();
-        error_response->set_error_message("You are not in any room. Join a room to send messages.");
+        error_response->set_error_message(publicMessage.room_name().empty()
+            ? "You are not in any room. Join a room to send messages."
+            : "You have not joined room '" + publicMessage.room_name() + "'.");
         error_response->set_error_code(403);
         session->send(response);
         return;
     }
+    const long long seq = roomService->nextSequence(room);
     Message message;
     message.setSenderId(senderId);
-    message.setRoomId(roomService->getUserCurrentRoomId(senderId));
+    message.setRoomId(room.roomId);
+    message.setRoomSeq(seq);
     message.setContent(publicMessage.content());
-    messageRepository->addMessage(message);
+    {
+        ScopedTimer timer(messageMetrics().persistDuration);
+        // 无论写库成败都要结束该序号，否则房间的同步进度会一直停在它前面
+        try {
+            if (!messageRepository->addMessage(message)) {
+                LOG_ERROR("public_message_persist_failed", "room_id", room.roomId, "room_seq", seq);
+            }
+        } catch (...) {
+            roomService->completeSequence(room, seq);
+            throw;
+        }
+        roomService->completeSequence(room, seq);
+    }
+    messageMetrics().publicMessages.inc();
 
     auto* messageBroadcast = response.mutable_message_broadcast();
     messageBroadcast->set_from_user_id(std::to_string(senderId));
     messageBroadcast->set_from_username(session->getUsername());
     messageBroadcast->set_content(publicMessage.content());
-    messageBroadcast->set_room_name(roomName);
+    messageBroadcast->set_room_name(room.name);
+    messageBroadcast->set_client_timestamp_us(publicMessage.client_timestamp_us());
+    messageBroadcast->set_room_seq(seq);
     *(messageBroadcast->mutable_timestamp()) = google::protobuf::util::TimeUtil::GetCurrentTime();
 
-    roomService->broadcastToRoom(roomService->getUserCurrentRoomName(session->getUserId()), response);
+    roomService->broadcastToRoom(room, response);
+    roomService->recordRecentMessage(room, response.message_broadcast());
 }
 
 void MessageService::handlePrivateMessage(std::shared_ptr<Session> session, const chat::PrivateMessageRequest& privateMessage) {
     chat::Envelope response;
     if (!session || !session->isAuthenticated()) {
-        std::cerr << "Warning: Unauthenticated session tried to send a private message." << std::endl;
+        LOG_WARN("unauthenticated_private_message");
         return;
     }
     long long senderId = session->getUserId();
@@ -45,9 +81,7 @@ void MessageService::handlePrivateMessage(std::shared_ptr<Session> session, cons
     std::string roomname = roomService->getUserCurrentRoomName(senderId);
 
     if (roomname.empty()) {
-        std::cerr << "Warning: User " << session->getUsername() 
-                  << " (ID: " << senderId 
-                  << ") tried to send a private message without being in a room." << std::endl;
+        LOG_WARN("private_message_without_room", "user_id", senderId);
         auto* error_response = response.mutable_error_response();
         error_response->set_error_message("You are not in any room. Join a room to send messages.");
         error_response->set_error_code(403);
@@ -57,10 +91,7 @@ void MessageService::handlePrivateMessage(std::shared_ptr<Session> session, cons
 
     auto acceptSession = sessionManager->findByUsername(privateMessage.to_username());
     if (!acceptSession || !acceptSession->isAuthenticated()) {
-        std::cerr << "Warning: User " << session->getUsername() 
-                  << " (ID: " << senderId 
-                  << ") tried to send a private message to non-existent or unauthenticated user: " 
-                  << privateMessage.to_username() << std::endl;
+        LOG_WARN("private_message_target_offline", "user_id", senderId, "target", privateMessage.to_username());
         auto* error_response = response.mutable_error_response();
         error_response->set_error_message("The user " + privateMessage.to_username() + " you are trying to message does not exist or is not online.");
         error_response->set_error_code(404);
@@ -68,9 +99,7 @@ void MessageService::handlePrivateMessage(std::shared_ptr<Session> session, cons
         return;
     }
     if (acceptSession->getUserId() == senderId) {
-        std::cerr << "Warning: User " << session->getUsername() 
-                  << " (ID: " << senderId 
-                  << ") tried to send a private message to themselves." << std::endl;
+        LOG_WARN("private_message_to_self", "user_id", senderId);
         auto* error_response = response.mutable_error_response();
         error_response->set_error_message("You cannot send a private message to yourself.");
         error_response->set_error_code(400);
@@ -83,6 +112,7 @@ void MessageService::handlePrivateMessage(std::shared_ptr<Session> session, cons
     messageBroadcast->set_content(privateMessage.content());
     messageBroadcast->set_room_name(roomname);
     *(messageBroadcast->mutable_timestamp()) = google::protobuf::util::TimeUtil::GetCurrentTime();
+    messageMetrics().privateMessages.inc();
     acceptSession->send(response);
     session->send(response);
 }
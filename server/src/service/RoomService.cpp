@@ -1,8 +1,38 @@
 #include "RoomService.h"
+#include "telemetry/Metrics.h"
+#include "util/Logger.h"
+#include "telemetry/Tracer.h"
+#include <algorithm>
+
+namespace {
+    struct RoomMetrics {
+        Counter& joins = MetricsRegistry::getInstance().counter("chat_room_operations_total", "Room operations", "op=\"join\"");
+        Counter& leaves = MetricsRegistry::getInstance().counter("chat_room_operations_total", "Room operations", "op=\"leave\"");
+        Counter& creates = MetricsRegistry::getInstance().counter("chat_room_operations_total", "Room operations", "op=\"create\"");
+        Counter& historyRequests = MetricsRegistry::getInstance().counter("chat_history_requests_total", "History requests served");
+        Counter& syncFromMemory = MetricsRegistry::getInstance().counter("chat_sync_requests_total", "Sync requests served", "source=\"memory\"");
+        Counter& syncFromDatabase = MetricsRegistry::getInstance().counter("chat_sync_requests_total", "Sync requests served", "source=\"database\"");
+        Histogram& syncMessages = MetricsRegistry::getInstance().histogram("chat_sync_messages",
+            "Messages returned per sync request", MetricsRegistry::exponentialBuckets(1, 4, 8));
+        Gauge& activeRooms = MetricsRegistry::getInstance().gauge("chat_rooms_active", "Rooms with at least one member");
+        Counter& presenceEvents = MetricsRegistry::getInstance().counter("chat_presence_events_total", "Join/leave events queued for coalescing");
+        Counter& presenceDiffs = MetricsRegistry::getInstance().counter("chat_presence_diffs_total", "Coalesced presence diffs broadcast");
+        Counter& snapshotBuilds = MetricsRegistry::getInstance().counter("chat_room_snapshots_total", "Join snapshots", "result=\"built\"");
+        Counter& snapshotHits = MetricsRegistry::getInstance().counter("chat_room_snapshots_total", "Join snapshots", "result=\"reused\"");
+        Histogram& fanout = MetricsRegistry::getInstance().histogram("chat_broadcast_recipients",
+            "Recipients per room broadcast", MetricsRegistry::exponentialBuckets(1, 4, 10));
+        Histogram& fanoutDuration = MetricsRegistry::getInstance().histogram("chat_broadcast_duration_seconds",
+            "Time spent encoding and queueing a room broadcast", MetricsRegistry::latencyBucketsNs(), 1e9);
+    };
+    RoomMetrics& roomMetrics() {
+        static RoomMetrics metrics;
+        return metrics;
+    }
+}
 void RoomService::handleRoomOperation(std::shared_ptr<Session> session, const chat::RoomOperationRequest& request){
     chat::Envelope response;
     if (!session || !session->isAuthenticated()) {
-        std::cerr << "Warning: Unauthenticated session tried to perform room operation." << std::endl;
+        LOG_WARN("unauthenticated_room_operation");
         return;
     }
     long long userId = session->getUserId();
@@ -10,67 +40,81 @@ void RoomService::handleRoomOperation(std::shared_ptr<Session> session, const ch
     switch (request.operation()){
     case chat::RoomOperation::JOIN://join
         {
-            auto roomOpt = roomRepository->findByRoomName(roomname);
-            if (!roomOpt) {
-                response.mutable_room_operation_response()->set_success(false);
-                response.mutable_room_operation_response()->set_message("Room '" + roomname + "' does not exist.");
-                session->send(response);
-                return;
-            }
+            RoomRef joined;
+            bool newMember = false;
+            bool batched = false;
+            std::shared_ptr<const std::string> snapshot;
             {
-                std::lock_guard<std::recursive_mutex> lock(mutex);
-                auto userIt = userToRoomMap.find(userId);
-                if (userIt != userToRoomMap.end()) {
-                    const std::string& oldRoomName = userIt->second;
-                    auto roomIt = activeRooms.find(oldRoomName);
-                    if (roomIt != activeRooms.end()) {
-                        roomIt->second.members.erase(userId);
-                        if (roomIt->second.members.empty()) {
-                            activeRooms.erase(oldRoomName);
-                        }
+                LockGuard<ServerMutex> lock(mutex);
+                auto slotIt = slotByName.find(roomname);
+                if (slotIt != slotByName.end()) {
+                    newMember = addMemberLocked(slotIt->second, userId, session);
+                    joined = refLocked(slotIt->second);
+                    batched = newMember && queuePresenceLocked(joined, userId, session->getUsername(), true);
+                    if (request.want_snapshot()) {
+                        snapshot = snapshotLocked(roomSlots[slotIt->second]);
                     }
-                    userToRoomMap.erase(userId);
                 }
-                userToRoomMap[userId]=roomname;
-                if (activeRooms.find(roomname) != activeRooms.end()) {
-                    activeRooms[roomname].members[userId] = session;
+            }
+            if (!joined) {
+                // 房间当前没有活跃成员，需要查库确认存在
+                auto roomOpt = roomRepository->findByRoomName(roomname);
+                if (!roomOpt) {
+                    response.mutable_room_operation_response()->set_success(false);
+                    response.mutable_room_operation_response()->set_message("Room '" + roomname + "' does not exist.");
+                    session->send(response);
+                    return;
+                }
+                std::deque<chat::MessageBroadcast> recent = loadRecentMessages(*roomOpt);
+                const long long lastSeq = messageRepository->getLastSequence(roomOpt->getId());
+                LockGuard<ServerMutex> lock(mutex);
+                auto slotIt = slotByName.find(roomname);
+                uint32_t slot;
+                if (slotIt != slotByName.end()) {
+                    slot = slotIt->second; // 查库期间已被其他人激活，丢弃预热的消息
+                } else {
+                    slot = openRoomLocked(*roomOpt);
+                    roomSlots[slot].recent = std::move(recent);
+                    roomSlots[slot].lastSeq = std::max(roomSlots[slot].lastSeq, lastSeq);
                 }
-                else {
-                    Room room = *roomOpt;
-                    activeRooms[roomname].id = room.getId();
-                    activeRooms[roomname].creator_id = room.getCreatorId();
-                    activeRooms[roomname].name = room.getName();
-					activeRooms[roomname].members[userId] = session;
+                newMember = addMemberLocked(slot, userId, session);
+                joined = refLocked(slot);
+                batched = newMember && queuePresenceLocked(joined, userId, session->getUsername(), true);
+                if (request.want_snapshot()) {
+                    snapshot = snapshotLocked(roomSlots[slot]);
                 }
-                
             }
+            roomMetrics().joins.inc();
             response.mutable_room_operation_response()->set_success(true);
             response.mutable_room_operation_response()->set_message("Joined room "+roomname+" successfully.");
+            if (snapshot) {
+                response.mutable_room_operation_response()->set_snapshot(*snapshot);
+            }
             chat::Envelope joinNotification;
             auto* notification = joinNotification.mutable_server_notification();
             notification->set_event_type(chat::UserEventType::USER_JOINED);
             notification->set_user_id(std::to_string(userId));
             notification->set_username(session->getUsername());
             notification->set_message("User "+session->getUsername()+" has joined the room.");
-            broadcastToRoom(roomname, joinNotification, userId);
+            // 重复加入已订阅的房间只切换当前房间，不再通知其他成员
+            if (newMember && !batched) {
+                broadcastToRoom(joined, joinNotification, userId);
+            }
             break;
         }
         case chat::RoomOperation::LEAVE://left
         {
+            RoomRef left;
+            bool batched = false;
             {
-                std::lock_guard<std::recursive_mutex> lock(mutex);
-                auto userIt = userToRoomMap.find(userId);
-                if (userIt != userToRoomMap.end() && userIt->second == roomname) {
-                    userToRoomMap.erase(userIt);
-                    auto roomIt = activeRooms.find(roomname);
-                    if (roomIt != activeRooms.end()) {
-                        roomIt->second.members.erase(userId);
-                        if (roomIt->second.members.empty()) {
-                            activeRooms.erase(roomIt);
-                        }
-                    }
+                LockGuard<ServerMutex> lock(mutex);
+                auto slotIt = slotByName.find(roomname);
+                if (slotIt != slotByName.end()) {
+                    left = removeMemberLocked(userId, slotIt->second);
+                    batched = left && queuePresenceLocked(left, userId, session->getUsername(), false);
                 }
             }
+            roomMetrics().leaves.inc();
             response.mutable_room_operation_response()->set_success(true);
             response.mutable_room_operation_response()->set_message("Left room "+roomname+" successfully.");
             chat::Envelope leaveNotification;
@@ -79,7 +123,9 @@ void RoomService::handleRoomOperation(std::shared_ptr<Session> session, const ch
             notification->set_user_id(std::to_string(userId));
             notification->set_username(session->getUsername());
             notification->set_message("User "+session->getUsername()+" has left the room.");
-            broadcastToRoom(roomname, leaveNotification, userId);
+            if (left && !batched) {
+                broadcastToRoom(left, leaveNotification, userId);
+            }
             break;
         }
         case chat::RoomOperation::CREATE://create
@@ -94,13 +140,10 @@ void RoomService::handleRoomOperation(std::shared_ptr<Session> session, const ch
             room.setCreatorId(userId);
             if (roomRepository->addRoom(room)) {
                 {
-                    std::lock_guard<std::recursive_mutex> lock(mutex);
-                    userToRoomMap[userId] = roomname;
-                    activeRooms[roomname].id = room.getId();
-                    activeRooms[roomname].creator_id = userId;
-                    activeRooms[roomname].name = room.getName();
-                    activeRooms[roomname].members[userId] = session;
+                    LockGuard<ServerMutex> lock(mutex);
+                    addMemberLocked(openRoomLocked(room), userId, session);
                 }
+                roomMetrics().creates.inc();
                 response.mutable_room_operation_response()->set_success(true);
                 response.mutable_room_operation_response()->set_message("Created room " + roomname + " successfully.");
             }else {
@@ -121,36 +164,103 @@ void RoomService::handleRoomOperation(std::shared_ptr<Session> session, const ch
 void RoomService::handleHistoryRequest(std::shared_ptr<Session> session, const chat::HistoryMessageRequest& request){
     chat::Envelope response;
     if (!session || !session->isAuthenticated()) {
-        std::cerr << "Warning: Unauthenticated session tried to request message history." << std::endl;
+        LOG_WARN("unauthenticated_history_request");
         return;
     }
     std::string roomname = request.room_name();
-    {
-        std::lock_guard<std::recursive_mutex> lock(mutex);
-        auto userIt = userToRoomMap.find(session->getUserId());
-        if (userIt == userToRoomMap.end() || userIt->second != roomname) {
-            std::cerr << "Warning: User tried to request message history for a room they are not part of." << std::endl;
-            return;
-        }
+    const RoomRef room = getUserRoom(session->getUserId(), roomname);
+    if (!room) {
+        LOG_WARN("history_request_not_member", "user_id", session->getUserId(), "room", roomname);
+        return;
     }
-    long long roomId = getUserCurrentRoomId(session->getUserId());
+    roomMetrics().historyRequests.inc();
+    long long roomId = room.roomId;
     int limit = request.limit() > 0 ? request.limit() : 50;
     std::vector<Message> messages(std::move(messageRepository->findLatestByRoomId(roomId, limit)));
     std::reverse(messages.begin(), messages.end());
+    std::unordered_map<long long, std::string> usernames;
     for(const auto& msg:messages){
-        auto* historyMsg = response.mutable_history_message_response()->add_messages();
-        historyMsg->set_from_user_id(std::to_string(msg.getSenderId()));
-        if (!userRepository->findByUserId(msg.getSenderId())) {
-            historyMsg->set_from_username("Unknown");
+        fillBroadcast(*response.mutable_history_message_response()->add_messages(), msg, roomname, usernames);
+    }
+    response.mutable_history_message_response()->set_room_name(roomname);
+    session->send(response);
+}
+void RoomService::handleSyncRequest(std::shared_ptr<Session> session, const chat::SyncRequest& request){
+    chat::Envelope response;
+    if (!session || !session->isAuthenticated()) {
+        LOG_WARN("unauthenticated_sync_request");
+        return;
+    }
+    const RoomRef ref = getUserRoom(session->getUserId(), request.room_name());
+    if (!ref) {
+        LOG_WARN("sync_request_not_member", "user_id", session->getUserId(), "room", request.room_name());
+        auto* error_response = response.mutable_error_response();
+        error_response->set_error_message("You have not joined room '" + request.room_name() + "'.");
+        error_response->set_error_code(403);
+        session->send(response);
+        return;
+    }
+    const long long since = request.since_seq();
+    const int limit = std::min(request.limit() > 0 ? request.limit() : 200, 1000);
+    auto* sync = response.mutable_sync_response();
+    sync->set_room_name(ref.name);
+    long long lastSeq = 0;
+    bool fromMemory = false;
+    {
+        LockGuard<ServerMutex> lock(mutex);
+        ActiveRoom* room = findRoomLocked(ref);
+        if (!room) {
+            LOG_WARN("sync_request_room_inactive", "user_id", session->getUserId(), "room", request.room_name());
+            auto* error_response = response.mutable_error_response();
+            error_response->set_error_message("Room '" + request.room_name() + "' is not active.");
+            error_response->set_error_code(403);
+            session->send(response);
+            return;
         }
-        else {
-            historyMsg->set_from_username(userRepository->findByUserId(msg.getSenderId())->getUsername());
+        // 序号在落库之前分配，只同步到已全部落库的序号为止，
+        // 否则库里可能先查到 7 而 6 还没写完，客户端会永久漏掉 6
+        lastSeq = room->committedSeq();
+        // 并发发送时较大的序号可能先进入 recent。
+        // 只有 recent 从 since+1 起连续覆盖到 lastSeq（或 limit 条）时才从内存返回，否则查库
+        if (since >= lastSeq) {
+            fromMemory = true;
+        } else {
+            auto it = std::upper_bound(room->recent.begin(), room->recent.end(), since,
+                [](long long seq, const chat::MessageBroadcast& message) { return seq < message.room_seq(); });
+            auto end = it;
+            long long expected = since + 1;
+            while (end != room->recent.end() && end->room_seq() == expected && expected - since <= limit) {
+                ++end;
+                ++expected;
+            }
+            fromMemory = expected > lastSeq || expected - since > limit;
+            for (; fromMemory && it != end; ++it) {
+                *sync->add_messages() = *it;
+            }
         }
-        historyMsg->set_content(msg.getContent());
-        historyMsg->set_room_name(roomname);
-        convertTimePointToTimestamp(msg.getCreatedAt(), historyMsg->mutable_timestamp());
     }
-    response.mutable_history_message_response()->set_room_name(roomname);
+    // 只有返回到 lastSeq 为止才算完整，否则客户端以最后一条的序号继续同步
+    bool complete = sync->messages().empty() ? since >= lastSeq : sync->messages().rbegin()->room_seq() == lastSeq;
+    if (fromMemory) {
+        roomMetrics().syncFromMemory.inc();
+    } else {
+        roomMetrics().syncFromDatabase.inc();
+        std::unordered_map<long long, std::string> usernames;
+        const std::vector<Message> messages = messageRepository->findByRoomIdAfterSequence(ref.roomId, since, limit);
+        // 不足 limit 条或越过 lastSeq 说明库里到 lastSeq 为止已取完，其间的空洞是写库失败的序号
+        bool exhausted = messages.size() < static_cast<size_t>(limit);
+        for (const Message& message : messages) {
+            if (message.getRoomSeq() > lastSeq) {
+                exhausted = true;
+                break;
+            }
+            fillBroadcast(*sync->add_messages(), message, ref.name, usernames);
+        }
+        complete = exhausted || (!sync->messages().empty() && sync->messages().rbegin()->room_seq() == lastSeq);
+    }
+    roomMetrics().syncMessages.observe(sync->messages_size());
+    sync->set_last_seq(lastSeq);
+    sync->set_complete(complete);
     session->send(response);
 }
 void RoomService::handleDisconnect(std::shared_ptr<Session> session){
@@ -158,68 +268,391 @@ void RoomService::handleDisconnect(std::shared_ptr<Session> session){
         return;
     }
     long long userId = session->getUserId();
-    std::lock_guard<std::recursive_mutex> lock(mutex);
-    auto userIt = userToRoomMap.find(userId);
-    if (userIt != userToRoomMap.end()) {
-        const std::string& roomName = userIt->second;
-        
-        chat::Envelope leaveNotification;
-        auto* notification = leaveNotification.mutable_server_notification();
-        notification->set_event_type(chat::UserEventType::USER_LEFT);
-        notification->set_user_id(std::to_string(userId));
-        notification->set_username(session->getUsername());
-        notification->set_message("User "+session->getUsername()+" has left the room.");
-        broadcastToRoom(roomName, leaveNotification, userId);
-
-        auto roomIt = activeRooms.find(roomName);
-        if (roomIt != activeRooms.end()) {
-            roomIt->second.members.erase(userId);
-            if (roomIt->second.members.empty()) {
-                activeRooms.erase(roomIt);
+    const std::string username = session->getUsername();
+    std::vector<RoomRef> leftRooms;
+    {
+        LockGuard<ServerMutex> lock(mutex);
+        for (RoomRef& room : removeAllLocked(userId)) {
+            if (!queuePresenceLocked(room, userId, username, false)) {
+                leftRooms.push_back(std::move(room));
             }
         }
-        userToRoomMap.erase(userIt);
+    }
+    if (leftRooms.empty()) {
+        return;
+    }
+    chat::Envelope leaveNotification;
+    auto* notification = leaveNotification.mutable_server_notification();
+    notification->set_event_type(chat::UserEventType::USER_LEFT);
+    notification->set_user_id(std::to_string(userId));
+    notification->set_username(username);
+    notification->set_message("User "+username+" has left the room.");
+    for (const RoomRef& room : leftRooms) {
+        broadcastToRoom(room, leaveNotification, userId);
     }
 }
-std::string RoomService::getUserCurrentRoomName(long long userId){
-    std::lock_guard<std::recursive_mutex> lock(mutex);
-    auto it = userToRoomMap.find(userId);
-    if (it != userToRoomMap.end()) {
-        return it->second;
+void RoomService::enablePresenceBatching(asio::io_context& ioc, const PresenceConfig& config){
+    LockGuard<ServerMutex> lock(mutex);
+    presenceConfig = config;
+    if (!presenceTimer) {
+        presenceTimer = std::make_unique<asio::steady_timer>(ioc);
+    }
+}
+void RoomService::stopPresenceBatching(){
+    LockGuard<ServerMutex> lock(mutex);
+    // 之后的进出恢复逐条通知；已排队的变化随定时器取消一起丢弃
+    presenceConfig.window = std::chrono::milliseconds(0);
+    if (presenceTimer) {
+        presenceTimer->cancel();
+    }
+}
+bool RoomService::queuePresenceLocked(const RoomRef& ref, long long userId, const std::string& username, bool joined){
+    if (presenceConfig.window.count() <= 0 || !presenceTimer) {
+        return false;
+    }
+    ActiveRoom* room = findRoomLocked(ref);
+    if (!room) {
+        return true; // 最后一个成员离开，房间已释放，没有人需要通知
+    }
+    roomMetrics().presenceEvents.inc();
+    auto it = room->pendingPresence.find(userId);
+    if (it != room->pendingPresence.end() && it->second.joined != joined) {
+        room->pendingPresence.erase(it); // 窗口内一进一出相互抵消
+    } else {
+        room->pendingPresence[userId] = PresenceChange{ username, joined };
+    }
+    if (!room->presenceQueued) {
+        room->presenceQueued = true;
+        dirtyRooms.push_back(ref);
+    }
+    if (!presenceTimerArmed) {
+        presenceTimerArmed = true;
+        presenceTimer->expires_after(presenceConfig.window);
+        presenceTimer->async_wait([this](const asio::error_code& ec) {
+            if (!ec) {
+                flushPresence();
+            }
+        });
+    }
+    return true;
+}
+void RoomService::flushPresence(){
+    std::vector<std::pair<RoomRef, chat::Envelope>> diffs;
+    {
+        LockGuard<ServerMutex> lock(mutex);
+        presenceTimerArmed = false;
+        for (const RoomRef& ref : dirtyRooms) {
+            ActiveRoom* room = findRoomLocked(ref);
+            if (!room) {
+                continue;
+            }
+            room->presenceQueued = false;
+            if (room->pendingPresence.empty()) {
+                continue;
+            }
+            chat::Envelope envelope;
+            auto* diff = envelope.mutable_presence_diff();
+            diff->set_room_name(room->name);
+            diff->set_member_count(static_cast<uint32_t>(room->members.size()));
+            if (presenceConfig.countOnlyThreshold != 0 && room->members.size() >= presenceConfig.countOnlyThreshold) {
+                diff->set_count_only(true);
+            } else {
+                for (const auto& [changedUserId, change] : room->pendingPresence) {
+                    auto* member = change.joined ? diff->add_joined() : diff->add_left();
+                    member->set_user_id(std::to_string(changedUserId));
+                    member->set_username(change.username);
+                }
+            }
+            room->pendingPresence.clear();
+            diffs.emplace_back(ref, std::move(envelope));
+        }
+        dirtyRooms.clear();
+    }
+    for (const auto& [room, envelope] : diffs) {
+        roomMetrics().presenceDiffs.inc();
+        broadcastToRoom(room, envelope);
+    }
+}
+void RoomService::setSnapshotConfig(const RoomSnapshotConfig& config){
+    LockGuard<ServerMutex> lock(mutex);
+    snapshotConfig = config;
+}
+void RoomService::recordRecentMessage(const RoomRef& ref, const chat::MessageBroadcast& message){
+    // 配置只在启动时设置，这里不加锁读取
+    if (snapshotConfig.recentMessages == 0) {
+        return;
+    }
+    LockGuard<ServerMutex> lock(mutex);
+    ActiveRoom* room = findRoomLocked(ref);
+    if (!room) {
+        return;
+    }
+    // 并发发送时记录顺序可能与序号不一致，按序号插入保持有序
+    if (room->recent.empty() || room->recent.back().room_seq() <= message.room_seq()) {
+        room->recent.push_back(message);
+    } else {
+        auto it = std::upper_bound(room->recent.begin(), room->recent.end(), message.room_seq(),
+            [](long long seq, const chat::MessageBroadcast& recent) { return seq < recent.room_seq(); });
+        room->recent.insert(it, message);
+    }
+    while (room->recent.size() > snapshotConfig.recentMessages) {
+        room->recent.pop_front();
+    }
+}
+long long RoomService::nextSequence(const RoomRef& ref){
+    LockGuard<ServerMutex> lock(mutex);
+    ActiveRoom* room = findRoomLocked(ref);
+    if (!room) {
+        return 0;
+    }
+    room->pendingSeqs.insert(++room->lastSeq);
+    return room->lastSeq;
+}
+void RoomService::completeSequence(const RoomRef& ref, long long seq){
+    LockGuard<ServerMutex> lock(mutex);
+    if (ActiveRoom* room = findRoomLocked(ref)) {
+        room->pendingSeqs.erase(seq);
+    }
+}
+std::shared_ptr<const std::string> RoomService::snapshotLocked(ActiveRoom& room){
+    const auto now = std::chrono::steady_clock::now();
+    if (room.snapshot && now - room.snapshotBuiltAt < snapshotConfig.ttl) {
+        roomMetrics().snapshotHits.inc();
+        return room.snapshot;
+    }
+    chat::RoomSnapshot snapshot;
+    snapshot.set_member_count(static_cast<uint32_t>(room.members.size()));
+    const size_t listed = std::min(room.members.size(), snapshotConfig.maxMembers);
+    for (size_t i = 0; i < listed; ++i) {
+        auto* member = snapshot.add_members();
+        member->set_user_id(std::to_string(room.members[i].userId));
+        if (room.members[i].session) {
+            member->set_username(room.members[i].session->getUsername());
+        }
+    }
+    for (const auto& message : room.recent) {
+        *snapshot.add_recent_messages() = message;
     }
-    return "";
+    auto serialized = std::make_shared<std::string>();
+    snapshot.SerializeToString(serialized.get());
+    room.snapshot = std::move(serialized);
+    room.snapshotBuiltAt = now;
+    roomMetrics().snapshotBuilds.inc();
+    return room.snapshot;
+}
+std::deque<chat::MessageBroadcast> RoomService::loadRecentMessages(const Room& room){
+    std::deque<chat::MessageBroadcast> recent;
+    if (snapshotConfig.recentMessages == 0) {
+        return recent;
+    }
+    std::vector<Message> messages = messageRepository->findLatestByRoomId(room.getId(), static_cast<int>(snapshotConfig.recentMessages));
+    std::unordered_map<long long, std::string> usernames;
+    for (auto it = messages.rbegin(); it != messages.rend(); ++it) {
+        fillBroadcast(recent.emplace_back(), *it, room.getName(), usernames);
+    }
+    return recent;
+}
+void RoomService::fillBroadcast(chat::MessageBroadcast& out, const Message& message, const std::string& roomName,
+    std::unordered_map<long long, std::string>& usernames){
+    auto nameIt = usernames.find(message.getSenderId());
+    if (nameIt == usernames.end()) {
+        auto user = userRepository->findByUserId(message.getSenderId());
+        nameIt = usernames.emplace(message.getSenderId(), user ? user->getUsername() : "Unknown").first;
+    }
+    out.set_from_user_id(std::to_string(message.getSenderId()));
+    out.set_from_username(nameIt->second);
+    out.set_content(message.getContent());
+    out.set_room_name(roomName);
+    out.set_room_seq(message.getRoomSeq());
+    convertTimePointToTimestamp(message.getCreatedAt(), out.mutable_timestamp());
+}
+RoomRef RoomService::getUserRoom(long long userId){
+    LockGuard<ServerMutex> lock(mutex);
+    auto it = userSubscriptions.find(userId);
+    return it != userSubscriptions.end() ? refLocked(it->second.currentSlot) : RoomRef();
+}
+RoomRef RoomService::getUserRoom(long long userId, const std::string& roomName){
+    LockGuard<ServerMutex> lock(mutex);
+    auto userIt = userSubscriptions.find(userId);
+    auto slotIt = slotByName.find(roomName);
+    if (userIt == userSubscriptions.end() || slotIt == slotByName.end()) {
+        return RoomRef();
+    }
+    for (const Subscription& subscription : userIt->second.rooms) {
+        if (subscription.slot == slotIt->second) {
+            return refLocked(subscription.slot);
+        }
+    }
+    return RoomRef();
+}
+std::string RoomService::getUserCurrentRoomName(long long userId){
+    return getUserRoom(userId).name;
 }
 long long RoomService::getUserCurrentRoomId(long long userId){
-    std::lock_guard<std::recursive_mutex> lock(mutex);
-    auto it = userToRoomMap.find(userId);
-    if (it != userToRoomMap.end()) {
-        const std::string& roomName = it->second;
-        auto roomIt = activeRooms.find(roomName);
-        if (roomIt != activeRooms.end()) {
-            return roomIt->second.id;
+    return getUserRoom(userId).roomId;
+}
+RoomService::ActiveRoom* RoomService::findRoomLocked(const RoomRef& room){
+    if (!room || room.slot >= roomSlots.size() || roomSlots[room.slot].generation != room.generation) {
+        return nullptr;
+    }
+    return &roomSlots[room.slot];
+}
+RoomRef RoomService::refLocked(uint32_t slot) const{
+    const ActiveRoom& room = roomSlots[slot];
+    RoomRef ref;
+    ref.slot = slot;
+    ref.generation = room.generation;
+    ref.roomId = room.id;
+    ref.name = room.name;
+    return ref;
+}
+uint32_t RoomService::openRoomLocked(const Room& room){
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(roomSlots.size());
+        roomSlots.emplace_back();
+    }
+    ActiveRoom& active = roomSlots[slot];
+    active.id = room.getId();
+    active.creator_id = room.getCreatorId();
+    active.name = room.getName();
+    auto seqIt = lastSeqByRoomId.find(active.id);
+    active.lastSeq = seqIt != lastSeqByRoomId.end() ? seqIt->second : 0;
+    active.generation = nextGeneration++;
+    if (nextGeneration == 0) {
+        nextGeneration = 1;
+    }
+    slotByName[active.name] = slot;
+    roomMetrics().activeRooms.set(static_cast<int64_t>(roomSlots.size() - freeSlots.size()));
+    return slot;
+}
+bool RoomService::addMemberLocked(uint32_t slot, long long userId, std::shared_ptr<Session> session){
+    UserSubscriptions& subscriptions = userSubscriptions[userId];
+    subscriptions.currentSlot = slot;
+    for (const Subscription& subscription : subscriptions.rooms) {
+        if (subscription.slot == slot) {
+            return false;
         }
     }
-    return 0;
+    ActiveRoom& room = roomSlots[slot];
+    subscriptions.rooms.push_back({ slot, static_cast<uint32_t>(room.members.size()) });
+    room.members.push_back({ userId, std::move(session), &subscriptions, static_cast<uint32_t>(subscriptions.rooms.size() - 1) });
+    return true;
 }
-void RoomService::broadcastToRoom(const std::string& roomName, const chat::Envelope& envelope, long long excludeUserId) {
+RoomRef RoomService::removeMemberLocked(long long userId, uint32_t slot){
+    auto userIt = userSubscriptions.find(userId);
+    if (userIt == userSubscriptions.end()) {
+        return RoomRef();
+    }
+    UserSubscriptions& subscriptions = userIt->second;
+    auto subIt = std::find_if(subscriptions.rooms.begin(), subscriptions.rooms.end(),
+        [slot](const Subscription& subscription) { return subscription.slot == slot; });
+    if (subIt == subscriptions.rooms.end()) {
+        return RoomRef();
+    }
+    RoomRef previous = refLocked(slot);
+    const uint32_t subscriptionIndex = static_cast<uint32_t>(subIt - subscriptions.rooms.begin());
+    const uint32_t memberIndex = subIt->memberIndex;
+
+    // 成员数组与订阅列表都与末尾交换后删除，并修正被移动元素在对方那里记录的下标
+    ActiveRoom& room = roomSlots[slot];
+    if (memberIndex + 1 != room.members.size()) {
+        room.members[memberIndex] = std::move(room.members.back());
+        const RoomMember& moved = room.members[memberIndex];
+        moved.owner->rooms[moved.subscriptionIndex].memberIndex = memberIndex;
+    }
+    room.members.pop_back();
+    if (subscriptionIndex + 1 != subscriptions.rooms.size()) {
+        subscriptions.rooms[subscriptionIndex] = subscriptions.rooms.back();
+        const Subscription& moved = subscriptions.rooms[subscriptionIndex];
+        roomSlots[moved.slot].members[moved.memberIndex].subscriptionIndex = subscriptionIndex;
+    }
+    subscriptions.rooms.pop_back();
+
+    if (room.members.empty()) {
+        slotByName.erase(room.name);
+        if (room.lastSeq > 0) {
+            lastSeqByRoomId[room.id] = room.lastSeq;
+        }
+        room.generation = 0;
+        room.name.clear();
+        room.members.shrink_to_fit();
+        room.pendingPresence.clear();
+        room.presenceQueued = false;
+        room.recent.clear();
+        room.pendingSeqs.clear();
+        room.snapshot.reset();
+        freeSlots.push_back(slot);
+        roomMetrics().activeRooms.set(static_cast<int64_t>(roomSlots.size() - freeSlots.size()));
+    }
+    if (subscriptions.rooms.empty()) {
+        userSubscriptions.erase(userIt);
+    } else if (subscriptions.currentSlot == slot) {
+        subscriptions.currentSlot = subscriptions.rooms.back().slot;
+    }
+    return previous;
+}
+std::vector<RoomRef> RoomService::removeAllLocked(long long userId){
+    std::vector<RoomRef> left;
+    auto userIt = userSubscriptions.find(userId);
+    if (userIt == userSubscriptions.end()) {
+        return left;
+    }
+    std::vector<uint32_t> slots;
+    for (const Subscription& subscription : userIt->second.rooms) {
+        slots.push_back(subscription.slot);
+    }
+    for (uint32_t slot : slots) {
+        left.push_back(removeMemberLocked(userId, slot));
+    }
+    return left;
+}
+std::vector<std::shared_ptr<Session>> RoomService::collectRecipients(const RoomRef& roomRef, long long excludeUserId, bool& anyCompressed) {
     std::vector<std::shared_ptr<Session>> recipients;
-    { 
-        std::lock_guard<std::recursive_mutex> lock(mutex);
-        auto roomIt = activeRooms.find(roomName);
-        if (roomIt == activeRooms.end()) {
-            return;
+    anyCompressed = false;
+    LockGuard<ServerMutex> lock(mutex);
+    const ActiveRoom* room = findRoomLocked(roomRef);
+    if (!room) {
+        return recipients;
+    }
+    recipients.reserve(room->members.size());
+    for (const RoomMember& member : room->members) {
+        if (member.userId != excludeUserId && member.session) {
+            anyCompressed = anyCompressed || member.session->isCompressionEnabled();
+            recipients.push_back(member.session);
         }
-        const ActiveRoom& room = roomIt->second;
-        recipients.reserve(room.members.size());
-        for (const auto& memberPair : room.members) {
-            if (memberPair.first != excludeUserId) {
-                recipients.push_back(memberPair.second);
-            }
+    }
+    return recipients;
+}
+void RoomService::broadcastToRoom(const std::string& roomName, const chat::Envelope& envelope, long long excludeUserId) {
+    RoomRef room;
+    {
+        LockGuard<ServerMutex> lock(mutex);
+        auto slotIt = slotByName.find(roomName);
+        if (slotIt == slotByName.end()) {
+            return;
         }
+        room = refLocked(slotIt->second);
     }
+    broadcastToRoom(room, envelope, excludeUserId);
+}
+void RoomService::broadcastToRoom(const RoomRef& room, const chat::Envelope& envelope, long long excludeUserId) {
+    ScopedTimer timer(roomMetrics().fanoutDuration);
+    TraceSpan span("room.fanout");
+    span.setRoom(room.name);
+    bool anyCompressed = false;
+    const std::vector<std::shared_ptr<Session>> recipients = collectRecipients(room, excludeUserId, anyCompressed);
+    roomMetrics().fanout.observe(recipients.size());
+    span.setCount(static_cast<long long>(recipients.size()));
+    if (recipients.empty()) {
+        return;
+    }
+    // 只序列化/压缩一次，所有接收者共享同一份帧
+    auto frame = OutboundFrame::encode(envelope, anyCompressed);
     for (const auto& session_ptr : recipients) {
-        if (session_ptr) {
-            session_ptr->send(envelope);
-        }
+        session_ptr->send(frame);
     }
-}
\ No newline at end of file
+}
@@ -7,32 +7,137 @@
 #include <util/TimeConvert.h>
 #include "core/SessionManager.h"
 #include "data/DataAccess.h"
+#include <deque>
+#include <set>
 
 #ifdef GetCurrentTime
 #undef GetCurrentTime
 #endif
+// 活跃房间在服务内部的引用：slot 是房间表中的下标，房间存续期间不变；
+// 槽位在房间清空后会被复用，generation 用来识别过期的引用。名字只在进入房间时解析一次。
+struct RoomRef {
+    uint32_t slot = 0;
+    uint32_t generation = 0; // 0 表示不在任何房间
+    long long roomId = 0;
+    std::string name;
+    explicit operator bool() const { return generation != 0; }
+};
+
+// 进出房间通知的合并参数
+struct PresenceConfig {
+    std::chrono::milliseconds window{0}; // 0 表示不合并，每次进出立即逐条通知
+    size_t countOnlyThreshold = 0;       // 成员数达到该值的房间只下发成员数，0 表示不启用
+};
+
+// 加入房间时附带的快照参数
+struct RoomSnapshotConfig {
+    std::chrono::milliseconds ttl{1000}; // 快照生成后在这段时间内被后续加入者复用
+    size_t maxMembers = 200;             // 快照中最多列出的成员数
+    size_t recentMessages = 50;          // 每个活跃房间在内存中保留的最近消息数，0 表示不保留
+};
+
 class RoomService {
 private:
+    struct UserSubscriptions;
+    struct RoomMember {
+        long long userId;
+        std::shared_ptr<Session> session;
+        UserSubscriptions* owner;   // 指向该用户的订阅列表，unordered_map 节点地址稳定
+        uint32_t subscriptionIndex; // 在 owner->rooms 中的下标
+    };
+    struct PresenceChange {
+        std::string username;
+        bool joined;
+    };
     struct ActiveRoom {
-        long long id; 
-        long long creator_id;
+        long long id = 0;
+        long long creator_id = 0;
         std::string name;
-        std::unordered_map<long long, std::shared_ptr<Session>> members;
+        uint32_t generation = 0; // 0 表示空槽
+        std::vector<RoomMember> members; // 连续存放，删除时与末尾交换
+        std::unordered_map<long long, PresenceChange> pendingPresence; // 当前窗口内尚未下发的成员变化
+        bool presenceQueued = false; // 是否已在 dirtyRooms 中
+        std::deque<chat::MessageBroadcast> recent; // 最近消息，房间激活时从数据库预热
+        std::shared_ptr<const std::string> snapshot; // 已序列化的 RoomSnapshot
+        std::chrono::steady_clock::time_point snapshotBuiltAt;
+        long long lastSeq = 0; // 已分配的最大消息序号
+        std::set<long long> pendingSeqs; // 已分配但尚未写完库的序号
+        // 此序号及以前的消息都已落库（或写库失败、永远不会出现）
+        long long committedSeq() const { return pendingSeqs.empty() ? lastSeq : *pendingSeqs.begin() - 1; }
+    };
+    struct Subscription {
+        uint32_t slot;
+        uint32_t memberIndex; // 在 roomSlots[slot].members 中的下标
+    };
+    struct UserSubscriptions {
+        std::vector<Subscription> rooms;
+        uint32_t currentSlot = 0; // 最近加入的房间，未指定房间名的消息发往这里
     };
 public:
-    RoomService(std::recursive_mutex& mutex,IRoomRepository* roomRepository,IUserRepository* userRepository, IMessageRepository* messageRepository, SessionManager* sessionManager) : mutex(mutex),roomRepository(roomRepository), userRepository(userRepository), messageRepository(messageRepository), sessionManager(sessionManager) {}
+    RoomService(ServerMutex& mutex,IRoomRepository* roomRepository,IUserRepository* userRepository, IMessageRepository* messageRepository, SessionManager* sessionManager) : mutex(mutex),roomRepository(roomRepository), userRepository(userRepository), messageRepository(messageRepository), sessionManager(sessionManager) {}
     void handleRoomOperation(std::shared_ptr<Session> session, const chat::RoomOperationRequest& request);
     void handleHistoryRequest(std::shared_ptr<Session> session, const chat::HistoryMessageRequest& request);
+    // 返回序号大于 since_seq 的消息：内存中的最近消息能覆盖时不查库
+    void handleSyncRequest(std::shared_ptr<Session> session, const chat::SyncRequest& request);
     void handleDisconnect(std::shared_ptr<Session> session);
+    // 开启后进出房间的通知按房间在 window 内合并成一条 PresenceDiff
+    void enablePresenceBatching(asio::io_context& ioc, const PresenceConfig& config);
+    void stopPresenceBatching();
+    void setSnapshotConfig(const RoomSnapshotConfig& config);
+    // 把一条已广播的消息记入房间的最近消息
+    void recordRecentMessage(const RoomRef& room, const chat::MessageBroadcast& message);
+    // 为房间的下一条消息分配序号，房间已不活跃时返回 0。
+    // 分配出的序号在 completeSequence 之前不计入同步返回的 last_seq
+    long long nextSequence(const RoomRef& room);
+    // 序号对应的消息写库结束（成功或失败）
+    void completeSequence(const RoomRef& room, long long seq);
+    // 一次加锁取出用户当前房间（最近加入且仍订阅的房间）的槽位、数据库 ID 和名字，不在任何房间时返回空引用
+    RoomRef getUserRoom(long long userId);
+    // 用户订阅了 roomName 时返回该房间的引用
+    RoomRef getUserRoom(long long userId, const std::string& roomName);
     std::string getUserCurrentRoomName(long long userId);
     long long getUserCurrentRoomId(long long userId);
+    void broadcastToRoom(const RoomRef& room, const chat::Envelope& envelope, long long excludeUserId = 0);
     void broadcastToRoom(const std::string& roomName, const chat::Envelope& envelope, long long excludeUserId = 0);
+    // 在锁内取出房间成员（排除 excludeUserId）；anyCompressed 表示其中是否有会话启用了压缩
+    std::vector<std::shared_ptr<Session>> collectRecipients(const RoomRef& room, long long excludeUserId, bool& anyCompressed);
 private:
+    friend struct RoomServiceBenchAccess; // 基准测试直接填充大房间
+    // 以下函数需持有 mutex
+    ActiveRoom* findRoomLocked(const RoomRef& room);
+    RoomRef refLocked(uint32_t slot) const;
+    uint32_t openRoomLocked(const Room& room);
+    // 已订阅时只把该房间设为当前房间并返回 false
+    bool addMemberLocked(uint32_t slot, long long userId, std::shared_ptr<Session> session);
+    // 取消一个订阅，房间空了就释放槽位；返回被退出的房间（未订阅时为空引用）
+    RoomRef removeMemberLocked(long long userId, uint32_t slot);
+    // 取消用户的全部订阅，返回退出的房间
+    std::vector<RoomRef> removeAllLocked(long long userId);
+    // 把一次进出记入房间的待发变化并按需启动定时器；未开启合并时返回 false，由调用方立即通知
+    bool queuePresenceLocked(const RoomRef& room, long long userId, const std::string& username, bool joined);
+    void flushPresence();
+    // 返回房间的快照，超过 ttl 时重新生成
+    std::shared_ptr<const std::string> snapshotLocked(ActiveRoom& room);
+    // 房间激活前在锁外读取最近消息
+    std::deque<chat::MessageBroadcast> loadRecentMessages(const Room& room);
+    // 数据库消息转为广播格式，usernames 缓存已查过的发送者
+    void fillBroadcast(chat::MessageBroadcast& out, const Message& message, const std::string& roomName,
+        std::unordered_map<long long, std::string>& usernames);
+
     IRoomRepository* roomRepository;
     IMessageRepository* messageRepository;
     IUserRepository* userRepository;
     SessionManager* sessionManager;
-    std::recursive_mutex& mutex;
-    std::unordered_map<std::string, ActiveRoom> activeRooms;//roomname,ActiveRoom
-    std::unordered_map<long long, std::string> userToRoomMap;//userid,roomname
+    ServerMutex& mutex;
+    std::vector<ActiveRoom> roomSlots;
+    std::vector<uint32_t> freeSlots;
+    uint32_t nextGeneration = 1;
+    std::unordered_map<std::string, uint32_t> slotByName; // 只在进出房间和按名字查找时使用
+    std::unordered_map<long long, UserSubscriptions> userSubscriptions;
+    PresenceConfig presenceConfig;
+    std::unique_ptr<asio::steady_timer> presenceTimer;
+    bool presenceTimerArmed = false;
+    std::vector<RoomRef> dirtyRooms; // 有待发变化的房间，可能含已释放的过期引用
+    RoomSnapshotConfig snapshotConfig;
+    std::unordered_map<long long, long long> lastSeqByRoomId; // 房间释放时保存序号，再次激活时接着分配
 };
\ No newline at end of file
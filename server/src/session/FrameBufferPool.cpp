@@ -0,0 +1,187 @@
+#include "FrameBufferPool.h"
+#include "telemetry/Metrics.h"
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <vector>
+
+using Block = FrameBuffer::Block;
+
+namespace {
+    constexpr size_t slab_bytes = 64 * 1024;
+    constexpr size_t thread_cache_bytes = 256 * 1024;  // 每个线程每一级最多缓存的字节数
+    constexpr uint8_t oversize_class = FrameBufferPool::class_count;
+
+    static_assert(sizeof(Block) % alignof(Block) == 0, "block payload must stay aligned");
+
+    struct PoolMetrics {
+        Counter& acquires = MetricsRegistry::getInstance().counter("chat_frame_buffer_acquires_total",
+            "Frame buffers handed out by the pool");
+        Counter& slabAllocations = MetricsRegistry::getInstance().counter("chat_frame_buffer_heap_allocations_total",
+            "Heap allocations made by the frame buffer pool", "kind=\"slab\"");
+        Counter& oversizeAllocations = MetricsRegistry::getInstance().counter("chat_frame_buffer_heap_allocations_total",
+            "Heap allocations made by the frame buffer pool", "kind=\"oversize\"");
+    };
+    PoolMetrics& poolMetrics() {
+        static PoolMetrics metrics;
+        return metrics;
+    }
+
+    size_t classSize(uint8_t sizeClass) { return FrameBufferPool::min_class_size << sizeClass; }
+    size_t classStride(uint8_t sizeClass) { return sizeof(Block) + classSize(sizeClass); }
+    size_t classCacheLimit(uint8_t sizeClass) { return std::max<size_t>(4, thread_cache_bytes / classSize(sizeClass)); }
+    uint8_t classFor(size_t size) {
+        uint8_t sizeClass = 0;
+        while (classSize(sizeClass) < size) {
+            ++sizeClass;
+        }
+        return sizeClass;
+    }
+
+    struct FreeList {
+        Block* head = nullptr;
+        size_t count = 0;
+        void push(Block* block) {
+            block->next = head;
+            head = block;
+            ++count;
+        }
+        Block* pop() {
+            Block* block = head;
+            head = block->next;
+            --count;
+            return block;
+        }
+    };
+
+    // 各线程之间周转空闲块的全局仓库，按整条链表存取，持锁期间不遍历块。
+    // 有意不析构：退出阶段其它线程仍可能归还缓冲
+    struct Depot {
+        std::mutex mtx;
+        std::array<std::vector<FreeList>, FrameBufferPool::class_count> batches;
+    };
+    Depot& depot() {
+        static Depot* instance = new Depot;
+        return *instance;
+    }
+
+    // list 为空时调用：从仓库取一整条链表，仓库为空时切一片新的 slab
+    void refill(FreeList& list, uint8_t sizeClass) {
+        Depot& shared = depot();
+        {
+            std::lock_guard<std::mutex> lock(shared.mtx);
+            std::vector<FreeList>& source = shared.batches[sizeClass];
+            if (!source.empty()) {
+                list = source.back();
+                source.pop_back();
+                return;
+            }
+        }
+        const size_t stride = classStride(sizeClass);
+        const size_t blocks = std::max<size_t>(1, slab_bytes / stride);
+        char* slab = static_cast<char*>(::operator new(stride * blocks));
+        poolMetrics().slabAllocations.inc();
+        for (size_t i = 0; i < blocks; ++i) {
+            Block* block = new (slab + i * stride) Block;
+            block->capacity = static_cast<uint32_t>(classSize(sizeClass));
+            block->sizeClass = sizeClass;
+            list.push(block);
+        }
+    }
+    // 把 list 整条交给仓库
+    void giveBack(FreeList& list, uint8_t sizeClass) {
+        if (list.count == 0) {
+            return;
+        }
+        Depot& shared = depot();
+        {
+            std::lock_guard<std::mutex> lock(shared.mtx);
+            shared.batches[sizeClass].push_back(list);
+        }
+        list = FreeList();
+    }
+
+    // 线程退出后 ThreadCache 已析构，之后在该线程上的取还直接走仓库
+    thread_local bool threadCacheGone = false;
+    struct ThreadCache {
+        std::array<FreeList, FrameBufferPool::class_count> lists;
+        ~ThreadCache() {
+            for (uint8_t c = 0; c < FrameBufferPool::class_count; ++c) {
+                giveBack(lists[c], c);
+            }
+            threadCacheGone = true;
+        }
+    };
+    ThreadCache& threadCache() {
+        thread_local ThreadCache cache;
+        return cache;
+    }
+}
+
+FrameBuffer FrameBufferPool::acquire(size_t size) {
+    poolMetrics().acquires.inc();
+    Block* block = take(size);
+    block->refs.store(1, std::memory_order_relaxed);
+    return FrameBuffer(block);
+}
+void* FrameBufferPool::allocate(size_t size) {
+    return take(size)->bytes();
+}
+void FrameBufferPool::deallocate(void* ptr) {
+    release(reinterpret_cast<Block*>(static_cast<char*>(ptr) - sizeof(Block)));
+}
+Block* FrameBufferPool::take(size_t size) {
+    Block* block;
+    if (size > max_class_size) {
+        block = new (::operator new(sizeof(Block) + size)) Block;
+        poolMetrics().oversizeAllocations.inc();
+        block->capacity = static_cast<uint32_t>(size);
+        block->sizeClass = oversize_class;
+    } else {
+        const uint8_t sizeClass = classFor(size);
+        if (threadCacheGone) {
+            FreeList rest;
+            refill(rest, sizeClass);
+            block = rest.pop();
+            giveBack(rest, sizeClass);
+        } else {
+            FreeList& list = threadCache().lists[sizeClass];
+            if (list.count == 0) {
+                refill(list, sizeClass);
+            }
+            block = list.pop();
+        }
+    }
+    block->size = static_cast<uint32_t>(size);
+    block->next = nullptr;
+    return block;
+}
+void FrameBufferPool::release(Block* block) {
+    if (block->sizeClass == oversize_class) {
+        block->~Block();
+        ::operator delete(block);
+        return;
+    }
+    const uint8_t sizeClass = block->sizeClass;
+    if (threadCacheGone) {
+        FreeList single;
+        single.push(block);
+        giveBack(single, sizeClass);
+        return;
+    }
+    FreeList& list = threadCache().lists[sizeClass];
+    list.push(block);
+    if (list.count >= classCacheLimit(sizeClass)) {
+        giveBack(list, sizeClass);
+    }
+}
+std::string FrameBufferPool::describeStats() {
+    PoolMetrics& metrics = poolMetrics();
+    std::ostringstream out;
+    out << "[FrameBuffers] acquires=" << metrics.acquires.value()
+        << " slab_allocations=" << metrics.slabAllocations.value()
+        << " oversize_allocations=" << metrics.oversizeAllocations.value();
+    return out.str();
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// 帧收发缓冲的句柄。缓冲来自 FrameBufferPool，块头带引用计数：
+// 广播时所有接收者共享同一块，最后一个句柄析构（通常是最后一次写完成）时块回到池中。
+class FrameBuffer {
+public:
+    struct Block;
+
+    FrameBuffer() = default;
+    FrameBuffer(const FrameBuffer& other);
+    FrameBuffer(FrameBuffer&& other) noexcept : block(other.block) { other.block = nullptr; }
+    FrameBuffer& operator=(const FrameBuffer& other);
+    FrameBuffer& operator=(FrameBuffer&& other) noexcept;
+    ~FrameBuffer() { reset(); }
+
+    explicit operator bool() const { return block != nullptr; }
+    char* data() const;
+    size_t size() const;
+    size_t capacity() const;
+    void reset();
+private:
+    friend class FrameBufferPool;
+    explicit FrameBuffer(Block* block) : block(block) {}
+    Block* block = nullptr;
+};
+
+struct FrameBuffer::Block {
+    std::atomic<uint32_t> refs{1};
+    uint32_t size = 0;
+    uint32_t capacity = 0;
+    uint8_t sizeClass = 0;
+    Block* next = nullptr;   // 空闲时串在所属缓存的链表上
+    char* bytes() { return reinterpret_cast<char*>(this + 1); }
+};
+
+inline FrameBuffer::FrameBuffer(const FrameBuffer& other) : block(other.block) {
+    if (block) {
+        block->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+inline FrameBuffer& FrameBuffer::operator=(const FrameBuffer& other) {
+    FrameBuffer copy(other);
+    return *this = std::move(copy);
+}
+inline FrameBuffer& FrameBuffer::operator=(FrameBuffer&& other) noexcept {
+    if (this != &other) {
+        reset();
+        block = other.block;
+        other.block = nullptr;
+    }
+    return *this;
+}
+inline char* FrameBuffer::data() const { return block->bytes(); }
+inline size_t FrameBuffer::size() const { return block ? block->size : 0; }
+inline size_t FrameBuffer::capacity() const { return block ? block->capacity : 0; }
+
+// 按 2 的幂分级（64 B ~ 16 KB）的帧缓冲池。每个线程缓存各级的空闲块，
+// 缓存空了先从全局仓库批量取，仓库也空时一次分配一整片（slab）切成多块；
+// 线程缓存攒满上限时整条交还仓库，仓库按整条链表周转，块可以在一个线程取、在另一个线程还。
+// 超过最大级别的缓冲直接走堆分配。slab 不归还给系统，池的内存占用等于历史峰值。
+class FrameBufferPool {
+public:
+    FrameBufferPool() = delete;
+    static constexpr size_t min_class_size = 64;
+    static constexpr size_t class_count = 9;
+    static constexpr size_t max_class_size = min_class_size << (class_count - 1);
+
+    // size() 为 size 的缓冲，内容未初始化
+    static FrameBuffer acquire(size_t size);
+    // 不带引用计数的原始内存，供出站邮箱节点这类按帧创建的小对象复用同一套分级缓存
+    static void* allocate(size_t size);
+    static void deallocate(void* ptr);
+    // 取缓冲次数与真正向堆申请内存的次数
+    static std::string describeStats();
+private:
+    friend class FrameBuffer;
+    static FrameBuffer::Block* take(size_t size);
+    static void release(FrameBuffer::Block* block);
+};
+
+inline void FrameBuffer::reset() {
+    if (block && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        FrameBufferPool::release(block);
+    }
+    block = nullptr;
+}
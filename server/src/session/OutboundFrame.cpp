@@ -0,0 +1,53 @@
+#include "OutboundFrame.h"
+#include "codec/FrameCodec.h"
+#include "codec/ZstdCompressor.h"
+#include <cstring>
+
+namespace {
+    std::shared_ptr<const ZstdCompressor> frameCompressor;
+    size_t frameCompressionMinSize = 0;
+}
+
+void OutboundFrame::configureCompression(std::shared_ptr<const ZstdCompressor> compressor, size_t minSize) {
+    frameCompressor = std::move(compressor);
+    frameCompressionMinSize = minSize;
+}
+const ZstdCompressor* OutboundFrame::getCompressor() {
+    return frameCompressor.get();
+}
+size_t OutboundFrame::getCompressionMinSize() {
+    return frameCompressionMinSize;
+}
+std::shared_ptr<const OutboundFrame> OutboundFrame::encode(const chat::Envelope& envelope, bool withCompressed) {
+    auto frame = std::make_shared<OutboundFrame>();
+    switch (envelope.payload_case()) {
+    case chat::Envelope::kMessageBroadcast:
+        frame->priority = FramePriority::Normal;
+        break;
+    case chat::Envelope::kServerNotification:
+    case chat::Envelope::kPresenceDiff:
+        frame->priority = FramePriority::Notification;
+        break;
+    case chat::Envelope::kEphemeralSignal:
+        frame->priority = FramePriority::Ephemeral;
+        break;
+    default:
+        frame->priority = FramePriority::Critical;
+        break;
+    }
+    const size_t bodySize = envelope.ByteSizeLong();
+    frame->rawFrame = FrameBufferPool::acquire(FrameCodec::header_length + bodySize);
+    char* body = frame->rawFrame.data() + FrameCodec::header_length;
+    envelope.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(body));
+    FrameCodec::writeHeader(frame->rawFrame.data(), static_cast<uint32_t>(bodySize), false);
+    if (withCompressed && frameCompressor && bodySize >= frameCompressionMinSize) {
+        // 压缩输出先写到线程内复用的缓冲，确认更小后再拷进池化缓冲
+        thread_local std::string compressed;
+        if (frameCompressor->compress(body, bodySize, compressed) && compressed.size() < bodySize) {
+            frame->compressedFrame = FrameBufferPool::acquire(FrameCodec::header_length + compressed.size());
+            FrameCodec::writeHeader(frame->compressedFrame.data(), static_cast<uint32_t>(compressed.size()), true);
+            std::memcpy(frame->compressedFrame.data() + FrameCodec::header_length, compressed.data(), compressed.size());
+        }
+    }
+    return frame;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "chat.pb.h"
+#include "FrameBufferPool.h"
+#include "OutboundQueue.h"
+
+class ZstdCompressor;
+
+// 已编码的出站帧。一次序列化、最多一次压缩，广播时在所有接收者之间共享。
+// 消息体直接序列化到池化缓冲中预留的 4 字节帧头之后，不再经过中间字符串。
+class OutboundFrame {
+public:
+    static void configureCompression(std::shared_ptr<const ZstdCompressor> compressor, size_t minSize);
+    static const ZstdCompressor* getCompressor();
+    static size_t getCompressionMinSize();
+
+    // withCompressed 为 false 时不生成压缩帧，避免没有压缩接收者时白白压缩
+    static std::shared_ptr<const OutboundFrame> encode(const chat::Envelope& envelope, bool withCompressed);
+
+    FrameBuffer wire(bool compressed) const {
+        return compressed && compressedFrame ? compressedFrame : rawFrame;
+    }
+    FramePriority getPriority() const { return priority; }
+private:
+    FramePriority priority = FramePriority::Critical;
+    FrameBuffer rawFrame;
+    FrameBuffer compressedFrame;
+};
@@ -0,0 +1,52 @@
+#include "OutboundMailbox.h"
+
+OutboundMailbox::OutboundMailbox() : head(&stub), tail(&stub) {}
+
+OutboundMailbox::~OutboundMailbox() {
+    while (pop()) {
+    }
+}
+bool OutboundMailbox::push(FrameBuffer data, FramePriority priority) {
+    auto* node = new Node;
+    node->data = std::move(data);
+    node->priority = priority;
+    // 先计数再入队，保证 pending 不小于链表中的节点数
+    const bool wasEmpty = pending.fetch_add(1, std::memory_order_acq_rel) == 0;
+    enqueue(node);
+    return wasEmpty;
+}
+void OutboundMailbox::enqueue(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+std::unique_ptr<OutboundMailbox::Node> OutboundMailbox::pop() {
+    Node* first = tail;
+    Node* next = first->next.load(std::memory_order_acquire);
+    if (first == &stub) {
+        if (!next) {
+            return nullptr;
+        }
+        tail = next;
+        first = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+        tail = next;
+        return std::unique_ptr<Node>(first);
+    }
+    if (first != head.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    // first 是最后一个节点：补回 stub 后才能把它取走
+    enqueue(&stub);
+    next = first->next.load(std::memory_order_acquire);
+    if (next) {
+        tail = next;
+        return std::unique_ptr<Node>(first);
+    }
+    return nullptr;
+}
+bool OutboundMailbox::release(size_t count) {
+    return pending.fetch_sub(count, std::memory_order_acq_rel) != count;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "OutboundQueue.h"
+#include <atomic>
+#include <memory>
+#include <string>
+
+// 会话出站帧的无锁多生产者单消费者邮箱（Vyukov 侵入式链表）。
+// 任意线程都可以 push；pop/release 只在会话的 strand 上调用。
+class OutboundMailbox {
+public:
+    // 节点内存来自 FrameBufferPool 的线程缓存，扇出时每帧每个接收者不再各走一次堆分配
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        FrameBuffer data;
+        FramePriority priority = FramePriority::Normal;
+        static void* operator new(size_t size) { return FrameBufferPool::allocate(size); }
+        static void operator delete(void* ptr) { FrameBufferPool::deallocate(ptr); }
+    };
+
+    OutboundMailbox();
+    ~OutboundMailbox();
+    OutboundMailbox(const OutboundMailbox&) = delete;
+    OutboundMailbox& operator=(const OutboundMailbox&) = delete;
+
+    // 返回 true 表示邮箱由空变为非空，调用方负责安排一次 drain
+    bool push(FrameBuffer data, FramePriority priority);
+    // 生产者正好入队到一半时可能暂时返回空，由 release 的返回值兜底
+    std::unique_ptr<Node> pop();
+    // drain 取走 count 帧后调用；返回 true 表示还有帧未取走，需要再安排一次 drain
+    bool release(size_t count);
+private:
+    void enqueue(Node* node);
+
+    std::atomic<Node*> head;          // 生产者端
+    Node* tail;                       // 消费者端
+    Node stub;
+    std::atomic<size_t> pending{0};   // 已 push 未 release 的帧数
+};
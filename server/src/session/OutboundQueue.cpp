@@ -0,0 +1,185 @@
+#include "OutboundQueue.h"
+#include "telemetry/Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+
+namespace {
+    OutboundLimits limits;
+    std::atomic<size_t> globalQueuedBytes{0};
+
+    struct OutboundMetrics {
+        Histogram& depthFrames = MetricsRegistry::getInstance().histogram("chat_outbound_queue_depth_frames",
+            "Per-session outbound queue depth in frames, sampled on every enqueue",
+            MetricsRegistry::exponentialBuckets(1, 2, 15));
+        Histogram& depthBytes = MetricsRegistry::getInstance().histogram("chat_outbound_queue_depth_bytes",
+            "Per-session outbound queue depth in bytes, sampled on every enqueue",
+            MetricsRegistry::exponentialBuckets(1024, 2, 15));
+        Counter& droppedFrames = MetricsRegistry::getInstance().counter("chat_outbound_dropped_frames_total",
+            "Outbound frames dropped by the slow-consumer policy");
+        Counter& overflowDisconnects = MetricsRegistry::getInstance().counter("chat_outbound_overflow_disconnects_total",
+            "Sessions disconnected because their outbound queue stayed over the limit");
+        Histogram& writeBatchFrames = MetricsRegistry::getInstance().histogram("chat_outbound_write_batch_frames",
+            "Frames written by a single gather write",
+            MetricsRegistry::exponentialBuckets(1, 2, 8));
+        OutboundMetrics() {
+            MetricsRegistry::getInstance().gaugeCallback("chat_outbound_queued_bytes",
+                "Bytes queued for sending across all sessions",
+                []() { return static_cast<double>(globalQueuedBytes.load(std::memory_order_relaxed)); });
+        }
+    };
+    OutboundMetrics& outboundMetrics() {
+        static OutboundMetrics metrics;
+        return metrics;
+    }
+
+    bool isEphemeral(FramePriority priority) { return priority == FramePriority::Ephemeral; }
+    bool isNotification(FramePriority priority) { return priority == FramePriority::Notification || isEphemeral(priority); }
+    bool isNonCritical(FramePriority priority) { return priority != FramePriority::Critical; }
+}
+
+void OutboundQueue::configure(const OutboundLimits& newLimits) {
+    limits = newLimits;
+}
+const OutboundLimits& OutboundQueue::getLimits() {
+    return limits;
+}
+OutboundLimits::Policy OutboundQueue::parsePolicy(const std::string& name) {
+    if (name == "disconnect") {
+        return OutboundLimits::Policy::Disconnect;
+    }
+    if (name == "drop_notifications") {
+        return OutboundLimits::Policy::DropNotifications;
+    }
+    return OutboundLimits::Policy::DropOldest;
+}
+size_t OutboundQueue::getGlobalQueuedBytes() {
+    return globalQueuedBytes.load(std::memory_order_relaxed);
+}
+std::string OutboundQueue::describeStats() {
+    OutboundMetrics& metrics = outboundMetrics();
+    std::ostringstream out;
+    out << "[Outbound] queued_bytes=" << getGlobalQueuedBytes()
+        << " dropped_frames=" << metrics.droppedFrames.value()
+        << " overflow_disconnects=" << metrics.overflowDisconnects.value()
+        << " depth_frames_p99=" << metrics.depthFrames.quantile(0.99)
+        << " depth_bytes_p99=" << metrics.depthBytes.quantile(0.99)
+        << " write_batch_p50=" << metrics.writeBatchFrames.quantile(0.5)
+        << " write_batch_p99=" << metrics.writeBatchFrames.quantile(0.99);
+    return out.str();
+}
+
+OutboundQueue::~OutboundQueue() {
+    globalQueuedBytes.fetch_sub(queuedBytes, std::memory_order_relaxed);
+}
+bool OutboundQueue::push(FrameBuffer data, FramePriority priority) {
+    queuedBytes += data.size();
+    ++queuedFrames;
+    globalQueuedBytes.fetch_add(data.size(), std::memory_order_relaxed);
+    pushBack(Entry{ std::move(data), priority });
+    OutboundMetrics& metrics = outboundMetrics();
+    metrics.depthFrames.observe(queuedFrames);
+    metrics.depthBytes.observe(queuedBytes);
+    if (!overLimit()) {
+        return true;
+    }
+    // 短暂信号过时即无用，先于任何其他帧丢弃，也不因它们断开连接
+    dropWhile(isEphemeral);
+    if (!overLimit()) {
+        return true;
+    }
+    switch (limits.policy) {
+    case OutboundLimits::Policy::DropOldest:
+        dropWhile(isNonCritical);
+        break;
+    case OutboundLimits::Policy::DropNotifications:
+        dropWhile(isNotification);
+        break;
+    case OutboundLimits::Policy::Disconnect:
+        break;
+    }
+    if (overLimit()) {
+        metrics.overflowDisconnects.inc();
+        return false;
+    }
+    return true;
+}
+size_t OutboundQueue::completeWrite() {
+    const size_t written = inFlightFrames;
+    outboundMetrics().writeBatchFrames.observe(written);
+    for (; inFlightFrames > 0; --inFlightFrames) {
+        release(at(0));
+        popFront();
+    }
+    return written;
+}
+void OutboundQueue::dropPending() {
+    for (size_t i = inFlightFrames; i < count; ++i) {
+        release(at(i));
+    }
+    truncate(inFlightFrames);
+}
+bool OutboundQueue::overLimit() const {
+    if (queuedBytes > limits.maxQueuedBytes || queuedFrames > limits.maxQueuedFrames) {
+        return true;
+    }
+    // 全局预算耗尽时，只让有积压的会话让出内存
+    return queuedFrames > std::max<size_t>(inFlightFrames, 1) && globalQueuedBytes.load(std::memory_order_relaxed) > limits.globalBudgetBytes;
+}
+void OutboundQueue::dropWhile(bool (*droppable)(FramePriority)) {
+    size_t out = inFlightFrames;
+    for (size_t i = inFlightFrames; i < count; ++i) {
+        Entry& entry = at(i);
+        if (overLimit() && droppable(entry.priority)) {
+            release(entry);
+            outboundMetrics().droppedFrames.inc();
+            continue;
+        }
+        if (out != i) {
+            at(out) = std::move(entry);
+        }
+        ++out;
+    }
+    truncate(out);
+}
+void OutboundQueue::release(const Entry& entry) {
+    queuedBytes -= entry.data.size();
+    --queuedFrames;
+    globalQueuedBytes.fetch_sub(entry.data.size(), std::memory_order_relaxed);
+}
+void OutboundQueue::pushBack(Entry entry) {
+    if (count == capacity) {
+        const uint32_t grown = capacity == 0 ? 4 : capacity * 2;
+        std::unique_ptr<Entry[]> next(new Entry[grown]);
+        for (uint32_t i = 0; i < count; ++i) {
+            next[i] = std::move(at(i));
+        }
+        ring = std::move(next);
+        capacity = grown;
+        head = 0;
+    }
+    at(count) = std::move(entry);
+    ++count;
+}
+void OutboundQueue::popFront() {
+    at(0).data.reset();
+    head = (head + 1) & (capacity - 1);
+    --count;
+    truncate(count);
+}
+void OutboundQueue::truncate(size_t newCount) {
+    for (size_t i = newCount; i < count; ++i) {
+        at(i).data.reset();
+    }
+    count = static_cast<uint32_t>(newCount);
+    if (count == 0) {
+        head = 0;
+    }
+}
+void OutboundQueue::releaseStorage() {
+    if (count == 0) {
+        ring.reset();
+        capacity = 0;
+        head = 0;
+    }
+}
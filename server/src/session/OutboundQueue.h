@@ -0,0 +1,99 @@
+#pragma once
+
+#include "FrameBufferPool.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 出站帧的优先级，超限时按优先级丢弃
+enum class FramePriority : uint8_t {
+    Critical,     // 登录/错误/房间操作等请求的响应，永不丢弃
+    Normal,       // 聊天消息广播
+    Notification, // 加入/离开等通知
+    Ephemeral     // 输入中等短暂信号，任何策略下都最先丢弃
+};
+
+struct OutboundLimits {
+    enum class Policy { DropOldest, DropNotifications, Disconnect };
+    size_t maxQueuedBytes = 1024 * 1024;
+    size_t maxQueuedFrames = 1024;
+    size_t globalBudgetBytes = 256 * 1024 * 1024; // 所有会话出站队列的总内存预算
+    Policy policy = Policy::DropOldest;
+    // 发送合并窗口：非关键帧最多等待这么久再与其后的帧一起写出，0 表示立即写
+    int64_t flushWindowUs = 0;
+    size_t flushMaxBytes = 64 * 1024;  // 积压达到该字节数时不再等待窗口；也是单次聚集写的上限
+    size_t flushMaxFrames = 64;        // 单次聚集写的最大帧数
+};
+
+// 单个会话的有界出站队列，只在会话的 strand 上访问。
+// 队首的若干帧可能正在被一次聚集写写出，丢弃时总是保留它们。
+// 存储是按需分配的环形数组，队列清空后仍保留以免活跃会话每帧重新分配，
+// 由心跳的空闲检查调用 releaseStorage 释放，空闲会话不占内存（std::deque 默认构造就要分配数百字节）。
+class OutboundQueue {
+public:
+    struct Entry {
+        FrameBuffer data;
+        FramePriority priority;
+    };
+
+    static void configure(const OutboundLimits& limits);
+    static const OutboundLimits& getLimits();
+    static OutboundLimits::Policy parsePolicy(const std::string& name);
+    static size_t getGlobalQueuedBytes();
+    // 队列深度分布与丢弃/断开计数的摘要；完整直方图见 /metrics
+    static std::string describeStats();
+
+    OutboundQueue() = default;
+    ~OutboundQueue();
+    OutboundQueue(const OutboundQueue&) = delete;
+    OutboundQueue& operator=(const OutboundQueue&) = delete;
+
+    // 返回 false 表示按策略丢弃后仍然超限，调用方应断开连接
+    bool push(FrameBuffer data, FramePriority priority);
+    bool empty() const { return count == 0; }
+    bool writing() const { return inFlightFrames > 0; }
+    // 从队首取出不超过 maxFrames 帧、maxBytes 字节（至少一帧）标记为正在写出，按顺序交给 visit
+    template <typename Visit>
+    size_t beginWrite(size_t maxFrames, size_t maxBytes, Visit visit);
+    // 写完成，弹出 beginWrite 标记的帧，返回帧数
+    size_t completeWrite();
+    // 丢弃除正在写出的帧以外的所有帧
+    void dropPending();
+    // 队列为空时释放环形数组
+    void releaseStorage();
+    size_t size() const { return count; }
+    size_t bytes() const { return queuedBytes; }
+private:
+    bool overLimit() const;
+    void dropWhile(bool (*droppable)(FramePriority));
+    void release(const Entry& entry);
+    Entry& at(size_t index) { return ring[(head + index) & (capacity - 1)]; }
+    void pushBack(Entry entry);
+    void popFront();
+    // 只保留前 newCount 帧
+    void truncate(size_t newCount);
+
+    std::unique_ptr<Entry[]> ring;
+    uint32_t capacity = 0;   // 0 或 2 的幂
+    uint32_t head = 0;
+    uint32_t count = 0;
+    uint32_t inFlightFrames = 0;
+    size_t queuedBytes = 0;
+    size_t queuedFrames = 0;
+};
+
+template <typename Visit>
+size_t OutboundQueue::beginWrite(size_t maxFrames, size_t maxBytes, Visit visit) {
+    size_t batchBytes = 0;
+    inFlightFrames = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Entry& entry = at(i);
+        if (inFlightFrames > 0 && (inFlightFrames >= maxFrames || batchBytes + entry.data.size() > maxBytes)) {
+            break;
+        }
+        visit(entry.data);
+        batchBytes += entry.data.size();
+        ++inFlightFrames;
+    }
+    return inFlightFrames;
+}
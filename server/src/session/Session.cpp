@@ -1,31 +1,85 @@
 #include "Session.h"
 #include "core/Server.h"
-Session::Session(std::shared_ptr<asio::ip::tcp::socket> sock, Server& srv) : socket_ptr(sock), server(srv), strand(asio::make_strand(socket_ptr->get_executor())) {}
+#include "core/TimerWheel.h"
+#include "codec/FrameCodec.h"
+#include "codec/ZstdCompressor.h"
+#include "telemetry/Metrics.h"
+#include "telemetry/TrafficCapture.h"
+#include "util/Logger.h"
+#include <algorithm>
+#include <google/protobuf/descriptor.h>
+namespace {
+    struct SessionMetrics {
+        Gauge& active = MetricsRegistry::getInstance().gauge("chat_sessions_active", "Sessions currently alive");
+        Counter& opened = MetricsRegistry::getInstance().counter("chat_sessions_opened_total", "Sessions accepted");
+        Counter& framesIn = MetricsRegistry::getInstance().counter("chat_frames_received_total", "Frames received from clients");
+        Counter& bytesIn = MetricsRegistry::getInstance().counter("chat_bytes_received_total", "Bytes received from clients, including headers");
+        Counter& framesOut = MetricsRegistry::getInstance().counter("chat_frames_sent_total", "Frames written to clients");
+        Counter& bytesOut = MetricsRegistry::getInstance().counter("chat_bytes_sent_total", "Bytes written to clients, including headers");
+        Counter& parseErrors = MetricsRegistry::getInstance().counter("chat_frame_parse_errors_total", "Inbound frames that failed to decode");
+    };
+    SessionMetrics& sessionMetrics() {
+        static SessionMetrics metrics;
+        return metrics;
+    }
+    std::atomic<uint64_t> next_session_id{1};
+
+    // 基类先于 Session 构造，使传输层在会话之前就绪
+    struct TcpTransportHolder {
+        TcpTransport tcp;
+        explicit TcpTransportHolder(asio::ip::tcp::socket socket) : tcp(std::move(socket)) {}
+    };
+    class TcpSession : private TcpTransportHolder, public Session {
+    public:
+        TcpSession(asio::ip::tcp::socket socket, Server& srv) : TcpTransportHolder(std::move(socket)), Session(tcp, srv) {}
+    };
+}
+std::shared_ptr<Session> Session::create(asio::ip::tcp::socket socket, Server& srv)
+{
+    return std::make_shared<TcpSession>(std::move(socket), srv);
+}
+Session::Session(std::unique_ptr<Transport> transport, Server& srv) : Session(*transport, srv)
+{
+    owned_transport = std::move(transport);
+}
+Session::Session(Transport& transport, Server& srv) : server(srv), session_id(next_session_id.fetch_add(1, std::memory_order_relaxed)), transport(&transport), strand(srv.sessionStrand(session_id))
+{
+    sessionMetrics().active.add(1);
+    sessionMetrics().opened.inc();
+}
+Session::~Session()
+{
+    sessionMetrics().active.sub(1);
+}
 void Session::start()
 {
+    last_activity_ms.store(TimerWheel::nowMs(), std::memory_order_relaxed);
     do_read_header();
 }
 void Session::do_read_header()
 {
     auto self = shared_from_this();
-    asio::async_read(*socket_ptr, asio::buffer(header_buf, header_length),
-        asio::bind_executor(strand,
+    transport->asyncRead(asio::buffer(header_buf, header_length), strand,
                      [this, self](const asio::error_code &ec, size_t bytes_transferred)
                      {
                          if (!ec)
                          {
-                             const uint32_t body_length = ntohl(*reinterpret_cast<uint32_t *>(header_buf.data()));
+                             const uint32_t body_length = FrameCodec::readHeader(header_buf, body_compressed);
                              if (body_length > 0 && body_length < max_body_length)
+                             {
+                                 read_trace = Tracer::getInstance().sample(session_id);
+                                 read_start_us = read_trace ? Tracer::nowUs() : 0;
                                  do_read_body(body_length);
+                             }
                              else
                              {
-                                 std::cerr << "Invalid body length received: " << body_length << std::endl;
+                                 LOG_WARN("invalid_frame_length", "length", body_length);
                                  handle_error("Invalid length", asio::error_code());
                              }
                          }
                          else
                          {
-                             std::cerr << ">>> Actual error code: " << ec.value() << " (" << ec.message() << ")" << std::endl;
+                             LOG_DEBUG("read_header_error", "code", ec.value(), "error", ec.message());
                              if (ec == asio::error::eof || ec == asio::error::connection_reset)
                              {
                                  handle_error("Client disconnected gracefully during header read.", ec);
@@ -36,81 +90,197 @@ void Session::do_read_header()
                                  handle_error("Server closed", ec);
                                  return;
 							 }
-                             std::cerr << "Read header error: " << ec.message() << std::endl;
+                             LOG_WARN("read_header_failed", "error", ec.message());
                              handle_error("Read header", ec);
                          }
-                     }));
+                     });
 }
 void Session::do_read_body(const uint32_t body_length)
 {
-    body_buf.resize(body_length);
+    // 接收缓冲按需从池中取，帧处理完即归还
+    body_buf = FrameBufferPool::acquire(body_length);
     auto self = shared_from_this();
-    asio::async_read(*socket_ptr, asio::buffer(body_buf.data(), body_length),
-		asio::bind_executor(strand,
-                     [this, self](const asio::error_code &ec, size_t bytes_transferred)
+    transport->asyncRead(asio::buffer(body_buf.data(), body_length), strand,
+                     [this, self, body_length](const asio::error_code &ec, size_t bytes_transferred)
                      {
                          if (!ec)
                          {
                              chat::Envelope envelope;
-                             if (envelope.ParseFromArray(body_buf.data(), body_buf.size()))
+                             bool parsed = false;
+                             std::string decompressed;
+                             if (body_compressed)
+                             {
+                                 parsed = FrameCodec::decode(body_buf.data(), body_length, true, OutboundFrame::getCompressor(), max_body_length, decompressed)
+                                     && envelope.ParseFromString(decompressed);
+                             }
+                             else
                              {
-                                 server.onMessage(shared_from_this(), envelope);
+                                 parsed = envelope.ParseFromArray(body_buf.data(), body_length);
+                             }
+                             if (parsed)
+                             {
+                                 last_activity_ms.store(TimerWheel::nowMs(), std::memory_order_relaxed);
+                                 sessionMetrics().framesIn.inc();
+                                 sessionMetrics().bytesIn.inc(header_length + body_length);
+                                 if (TrafficCapture::getInstance().isEnabled())
+                                 {
+                                     if (body_compressed)
+                                         TrafficCapture::getInstance().recordEnvelope(session_id, envelope, decompressed.data(), decompressed.size());
+                                     else
+                                         TrafficCapture::getInstance().recordEnvelope(session_id, envelope, body_buf.data(), body_length);
+                                 }
+                                 if (read_trace)
+                                 {
+                                     if (Authenticated)
+                                         read_trace.userId = userId;
+                                     if (const auto* field = chat::Envelope::descriptor()->FindFieldByNumber(envelope.payload_case()))
+                                         read_trace.payload = field->name().c_str();
+                                 }
+                                 {
+                                     TraceScope trace_scope(read_trace);
+                                     Tracer::getInstance().emit("session.read_frame", read_start_us, Tracer::nowUs());
+                                     server.onMessage(shared_from_this(), envelope);
+                                 }
+                                 body_buf.reset();
                                  do_read_header();
                              }
                              else
                              {
-                                 std::cerr << "Failed to parse message body." << std::endl;
+                                 sessionMetrics().parseErrors.inc();
+                                 LOG_WARN("frame_parse_failed", "length", body_length);
                                  handle_error("Failed to parse", asio::error_code());
                              }
                          }
                          else
                          {
-                             std::cerr << "Read body error: " << ec.message() << std::endl;
+                             LOG_WARN("read_body_failed", "error", ec.message());
                              handle_error("Read body", ec);
                          }
-                     }));
+                     });
 }
 void Session::send(const chat::Envelope &envelope)
 {
-    std::string body_data;
-    envelope.SerializeToString(&body_data);
-    uint32_t body_length = htonl(body_data.size());
-    std::string write_buf;
-    write_buf.reserve(body_data.size() + sizeof(body_length));
-    write_buf.append(reinterpret_cast<const char *>(&body_length), sizeof(body_length));
-    write_buf.append(body_data);
+    send(OutboundFrame::encode(envelope, isCompressionEnabled()));
+}
+void Session::send(const std::shared_ptr<const OutboundFrame> &frame)
+{
+    if (is_closed.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // 生产者直接入邮箱，只有邮箱由空变为非空时才向 strand 投递一次 drain
+    if (mailbox.push(frame->wire(isCompressionEnabled()), frame->getPriority())) {
+        auto self = shared_from_this();
+        asio::post(strand, [this, self]() { drain_mailbox(); });
+    }
+}
+void Session::drain_mailbox()
+{
+    size_t drained = 0;
+    bool critical = false;
+    while (auto node = mailbox.pop()) {
+        ++drained;
+        if (is_closed) {
+            continue;
+        }
+        critical = critical || node->priority == FramePriority::Critical;
+        if (!message_queue.push(std::move(node->data), node->priority)) {
+            close("Outbound queue limit exceeded");
+        }
+    }
+    // 正在写时新帧自然积压，写完成后一起写出
+    if (drained > 0 && !is_closed && !message_queue.writing()) {
+        schedule_flush(critical ? FramePriority::Critical : FramePriority::Normal);
+    }
+    if (mailbox.release(drained)) {
+        auto self = shared_from_this();
+        asio::post(strand, [this, self]() { drain_mailbox(); });
+    }
+}
+void Session::schedule_flush(FramePriority priority)
+{
+    const OutboundLimits &limits = OutboundQueue::getLimits();
+    // 关键帧（登录、错误等响应）不等待窗口，顺带写出已积压的帧
+    if (limits.flushWindowUs <= 0 || priority == FramePriority::Critical || message_queue.bytes() >= limits.flushMaxBytes)
+    {
+        do_write();
+        return;
+    }
+    if (flush_armed)
+    {
+        return;
+    }
+    flush_armed = true;
+    if (!flush_timer)
+    {
+        flush_timer = std::make_unique<asio::steady_timer>(strand);
+    }
+    flush_timer->expires_after(std::chrono::microseconds(limits.flushWindowUs));
     auto self = shared_from_this();
-    // ؼpost  strand ϣ socket  executor 
-    asio::post(strand,
-        [this, self, package = std::move(write_buf)]() mutable {
-            bool write_in_progress = !message_queue.empty();
-            message_queue.push(std::move(package));
-            if (!write_in_progress) {
-                do_write();
-            }
-        });
+    flush_timer->async_wait([this, self](const asio::error_code &ec) {
+        if (ec || !flush_armed)
+        {
+            return;
+        }
+        flush_armed = false;
+        if (!is_closed && !message_queue.writing() && !message_queue.empty())
+        {
+            do_write();
+        }
+    });
+}
+void Session::negotiateCompression(const chat::CompressionHello &hello)
+{
+    chat::Envelope response;
+    auto *accept = response.mutable_compression_accept();
+    accept->set_codec("none");
+    const ZstdCompressor *compressor = OutboundFrame::getCompressor();
+    bool supportsZstd = std::find(hello.codecs().begin(), hello.codecs().end(), "zstd") != hello.codecs().end();
+    if (compressor && supportsZstd && hello.dictionary_id() == compressor->getDictionaryId())
+    {
+        accept->set_codec("zstd");
+        accept->set_dictionary_id(compressor->getDictionaryId());
+        accept->set_min_size(static_cast<uint32_t>(OutboundFrame::getCompressionMinSize()));
+    }
+    // 协商响应本身以原始帧发出，之后的帧才可能被压缩
+    send(OutboundFrame::encode(response, false));
+    compression_enabled.store(accept->codec() == "zstd", std::memory_order_release);
+}
+bool Session::isCompressionEnabled() const
+{
+    return compression_enabled.load(std::memory_order_acquire);
 }
 void Session::do_write()
 {
-    const std::string &write_buf = message_queue.front();
+    if (flush_armed)
+    {
+        flush_armed = false;
+        flush_timer->cancel();
+    }
+    // 传输层在调用返回前就复制或用完了缓冲区序列，线程内复用一份即可，会话不必常驻持有
+    thread_local WriteBuffers write_buffers;
+    const OutboundLimits &limits = OutboundQueue::getLimits();
+    write_buffers.clear();
+    message_queue.beginWrite(limits.flushMaxFrames, limits.flushMaxBytes, [](const FrameBuffer &data) {
+        write_buffers.push_back(asio::buffer(data.data(), data.size()));
+    });
     auto self = shared_from_this();
-    asio::async_write(*socket_ptr, asio::buffer(write_buf),
-        asio::bind_executor(strand,
-            [this, self](const asio::error_code& ec, size_t bytes) {
-                handle_write(ec, bytes);
-            }));
+    transport->asyncWrite(write_buffers, strand,
+        [this, self](const asio::error_code& ec, size_t bytes) {
+            handle_write(ec, bytes);
+        });
 }
 void Session::handle_write(const asio::error_code &ec, size_t bytes_transferred)
 {
     if (!ec)
     {
-        message_queue.pop();
-        if (!message_queue.empty())
+        sessionMetrics().framesOut.inc(message_queue.completeWrite());
+        sessionMetrics().bytesOut.inc(bytes_transferred);
+        if (!message_queue.empty() && !is_closed)
             do_write();
     }
     else
     {
-        std::cerr << "Write error: " << ec.message() << std::endl;
+        LOG_WARN("write_failed", "error", ec.message());
         handle_error("Write", ec);
     }
 }
@@ -122,26 +292,64 @@ void Session::handle_error(const std::string &what, const asio::error_code &ec)
     }
     if (ec == asio::error::eof)
     {
-        std::cout << "[INFO] Session closed by peer (" << what << ")." << std::endl;
+        LOG_INFO("session_closed_by_peer", "context", what);
     }
     else if (ec == asio::error::operation_aborted)
     {
         return;
     }
     else if (ec == asio::error::connection_reset) {
-        std::cout << "[INFO] Connection reset by peer (" << what << ")." << std::endl;
+        LOG_INFO("connection_reset", "context", what);
     }
     else if (ec == asio::error::timed_out)
     {
-        std::cout << "[INFO] Session timed out (" << what << ")." << std::endl;
+        LOG_INFO("session_timed_out", "context", what);
     }
     else if (ec)
     {
-        std::cerr << "[ERROR] Session error in " << what << ": " << ec.message() << std::endl;
+        LOG_ERROR("session_error", "context", what, "error", ec.message());
     }
     is_closed = true;
+    TrafficCapture::getInstance().recordClose(session_id);
     server.onDisconnect(shared_from_this());
 }
+void Session::sendPing(int64_t nowMs)
+{
+    last_ping_ms.store(nowMs, std::memory_order_relaxed);
+    chat::Envelope envelope;
+    envelope.mutable_ping()->set_timestamp_ms(nowMs);
+    send(envelope);
+}
+void Session::releaseIdleBuffers()
+{
+    auto self = shared_from_this();
+    asio::post(strand, [this, self]() {
+        message_queue.releaseStorage();
+    });
+}
+void Session::expire()
+{
+    auto self = shared_from_this();
+    asio::post(strand, [this, self]() {
+        close("Idle timeout");
+    });
+}
+void Session::close(const std::string &reason)
+{
+    if (is_closed)
+    {
+        return;
+    }
+    LOG_INFO("session_closing", "reason", reason);
+    handle_error(reason, asio::error_code());
+    if (flush_armed)
+    {
+        flush_armed = false;
+        flush_timer->cancel();
+    }
+    message_queue.dropPending();
+    transport->close();
+}
 void Session::setAuthenticated(long long userId, const std::string &username)
 {
     this->userId = userId;
@@ -156,16 +364,16 @@ bool Session::isAuthenticated() const
 
 long long Session::getUserId() const
 {
-    if (!userId.has_value())
+    if (!Authenticated)
     {
         throw std::logic_error("User ID not set");
     }
-    return userId.value();
+    return userId;
 }
 
 std::string Session::getUsername() const
 {
-    return username.value();
+    return username;
 }
 
 void Session::setUsername(const std::string &newUsername)
@@ -175,7 +383,8 @@ void Session::setUsername(const std::string &newUsername)
 
 void Session::clearAuthentication()
 {
-    userId.reset();
-    username.reset();
+    userId = 0;
+    username.clear();
+    username.shrink_to_fit();
     Authenticated = false;
 }
\ No newline at end of file
@@ -3,42 +3,82 @@
 #include <iostream>
 #include <asio.hpp>
 #include <memory>
-#include <queue>
-#include <optional>
+#include <atomic>
 #include "chat.pb.h"
+#include "OutboundFrame.h"
+#include "OutboundMailbox.h"
+#include "OutboundQueue.h"
+#include "FrameBufferPool.h"
+#include "Transport.h"
+#include "telemetry/Tracer.h"
 class Server;
 class Session:public std::enable_shared_from_this<Session>{
 public:
-    Session(std::shared_ptr<asio::ip::tcp::socket> sock,Server& srv);
-    ~Session()=default;
+    // TCP 会话：socket、会话与 shared_ptr 控制块在同一次分配中
+    static std::shared_ptr<Session> create(asio::ip::tcp::socket socket, Server& srv);
+    Session(std::unique_ptr<Transport> transport,Server& srv);
+    ~Session();
     void start();
     void send(const chat::Envelope& envelope);
+    void send(const std::shared_ptr<const OutboundFrame>& frame);
+    void negotiateCompression(const chat::CompressionHello& hello);
+    bool isCompressionEnabled() const;
+    uint64_t getSessionId() const { return session_id; }
+    // 心跳与空闲检测，由 TimerWheel 调用
+    int64_t getLastActivityMs() const { return last_activity_ms.load(std::memory_order_relaxed); }
+    int64_t getLastPingMs() const { return last_ping_ms.load(std::memory_order_relaxed); }
+    bool isClosed() const { return is_closed.load(std::memory_order_relaxed); }
+    void sendPing(int64_t nowMs);
+    // 出站队列为空时释放其存储
+    void releaseIdleBuffers();
+    void expire();
     void setAuthenticated(long long userId, const std::string& username);
     bool isAuthenticated() const;
     void clearAuthentication();
     long long getUserId() const;
     std::string getUsername() const;
     void setUsername(const std::string& newUsername);
-    
+
+protected:
+    // 传输层由派生类持有，生命周期不短于会话
+    Session(Transport& transport, Server& srv);
 private:
     friend class Server;
+    friend class SessionManager;
     void do_read_header();
     void do_read_body(uint32_t body_length);
     void do_write();
+    // 把邮箱中的帧移入出站队列，只在 strand 上执行
+    void drain_mailbox();
+    // 按合并窗口决定立即写出还是等待定时器
+    void schedule_flush(FramePriority priority);
     void handle_write(const asio::error_code& ec,size_t bytes_transferred);
     void handle_error(const std::string& what,const asio::error_code& ec);
+    void close(const std::string& reason);
 
+    // 成员按大小排列以减少填充；百万连接时每个空闲会话的字节数都要计较
     Server& server;
-    bool is_closed = false;
-    std::shared_ptr<asio::ip::tcp::socket> socket_ptr;
-    asio::strand<asio::any_io_executor> strand;
-    std::queue<std::string> message_queue;
+    const uint64_t session_id;
+    std::atomic<int64_t> last_activity_ms{0};
+    std::atomic<int64_t> last_ping_ms{0};
+    std::unique_ptr<Transport> owned_transport;   // 仅非 TCP 会话使用
+    Transport* transport;
+    SessionStrand strand;          // 来自 Server 的共享 strand 池
+    OutboundMailbox mailbox;       // 任意线程写入，strand 上取出
+    OutboundQueue message_queue;
+    std::unique_ptr<asio::steady_timer> flush_timer;   // 首次需要等待合并窗口时才创建
+    FrameBuffer body_buf;          // 只在读帧体期间持有
+    TraceContext read_trace;   // 当前帧是否被采样追踪
+    int64_t read_start_us = 0;
+    long long userId = 0;
+    std::string username;
     static constexpr size_t header_length = 4;
     std::array<char,header_length> header_buf;
-    std::vector<char> body_buf;
-    static const uint32_t max_body_length = 8192;
-
-    std::optional<long long> userId;
-    std::optional<std::string> username;
+    std::atomic<bool> is_closed{false};
+    std::atomic<bool> compression_enabled{false};
+    bool body_compressed = false;
+    bool flush_armed = false;
     bool Authenticated = false;
+    static const uint32_t max_body_length = 8192;
+    static_assert(max_body_length <= FrameBufferPool::max_class_size, "frame body must fit a pooled size class");
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "Transport.h"
+#include <cstring>
+
+void TcpTransport::asyncRead(asio::mutable_buffer buffer, SessionStrand& strand, TransportHandler handler) {
+    asio::async_read(socket, buffer, asio::bind_executor(strand, std::move(handler)));
+}
+void TcpTransport::asyncWrite(const WriteBuffers& buffers, SessionStrand& strand, TransportHandler handler) {
+    asio::async_write(socket, buffers, asio::bind_executor(strand, std::move(handler)));
+}
+void TcpTransport::close() {
+    asio::error_code ignored;
+    socket.close(ignored);
+}
+
+LoopbackTransport::LoopbackTransport(asio::any_io_executor executor, Sink sink)
+    : executor(std::move(executor)), sink(std::move(sink)) {}
+
+void LoopbackTransport::asyncRead(asio::mutable_buffer buffer, SessionStrand& strand, TransportHandler handler) {
+    std::lock_guard<std::mutex> lock(mtx);
+    pendingBuffer = buffer;
+    pendingStrand = &strand;
+    pendingHandler = std::move(handler);
+    completePendingRead();
+}
+void LoopbackTransport::asyncWrite(const WriteBuffers& buffers, SessionStrand& strand, TransportHandler handler) {
+    asio::error_code ec;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (closed || peerClosed) {
+            ec = asio::error::broken_pipe;
+        }
+    }
+    const size_t total = asio::buffer_size(buffers);
+    if (!ec && sink) {
+        if (buffers.size() == 1) {
+            sink(static_cast<const char*>(buffers.front().data()), total);
+        } else {
+            // 对应一次 writev：拼成连续字节交给 sink
+            thread_local std::string gathered;
+            gathered.resize(total);
+            asio::buffer_copy(asio::buffer(gathered), buffers);
+            sink(gathered.data(), gathered.size());
+        }
+    }
+    const size_t written = ec ? 0 : total;
+    asio::post(strand, [handler = std::move(handler), ec, written]() { handler(ec, written); });
+}
+void LoopbackTransport::close() {
+    std::lock_guard<std::mutex> lock(mtx);
+    closed = true;
+    completePendingRead();
+}
+void LoopbackTransport::deliver(const char* data, size_t size) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (readOffset == inbound.size()) {
+        inbound.clear();
+        readOffset = 0;
+    } else if (readOffset > 65536) {
+        inbound.erase(0, readOffset);
+        readOffset = 0;
+    }
+    inbound.append(data, size);
+    completePendingRead();
+}
+void LoopbackTransport::shutdown() {
+    std::lock_guard<std::mutex> lock(mtx);
+    peerClosed = true;
+    completePendingRead();
+}
+void LoopbackTransport::completePendingRead() {
+    if (!pendingHandler) {
+        return;
+    }
+    asio::error_code ec;
+    size_t transferred = 0;
+    const size_t available = inbound.size() - readOffset;
+    if (closed) {
+        ec = asio::error::operation_aborted;
+    } else if (available >= pendingBuffer.size()) {
+        std::memcpy(pendingBuffer.data(), inbound.data() + readOffset, pendingBuffer.size());
+        readOffset += pendingBuffer.size();
+        transferred = pendingBuffer.size();
+    } else if (peerClosed) {
+        ec = asio::error::eof;
+    } else {
+        return;
+    }
+    asio::post(*pendingStrand, [handler = std::move(pendingHandler), ec, transferred]() { handler(ec, transferred); });
+    pendingHandler = nullptr;
+    pendingStrand = nullptr;
+}
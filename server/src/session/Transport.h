@@ -0,0 +1,65 @@
+#pragma once
+
+#include <asio.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using SessionStrand = asio::strand<asio::any_io_executor>;
+using TransportHandler = std::function<void(const asio::error_code&, size_t)>;
+
+using WriteBuffers = std::vector<asio::const_buffer>;
+
+// Session 下层的字节流。读写都是"读满/写完"语义，回调在调用方给出的 strand 上执行。
+// 写操作接受一组缓冲区，一次聚集写出；缓冲区序列在调用返回后即可复用，其指向的数据须保持到回调
+class Transport {
+public:
+    virtual ~Transport() = default;
+    virtual asio::any_io_executor getExecutor() = 0;
+    virtual void asyncRead(asio::mutable_buffer buffer, SessionStrand& strand, TransportHandler handler) = 0;
+    virtual void asyncWrite(const WriteBuffers& buffers, SessionStrand& strand, TransportHandler handler) = 0;
+    virtual void close() = 0;
+};
+
+class TcpTransport : public Transport {
+public:
+    explicit TcpTransport(asio::ip::tcp::socket socket) : socket(std::move(socket)) {}
+    asio::any_io_executor getExecutor() override { return socket.get_executor(); }
+    void asyncRead(asio::mutable_buffer buffer, SessionStrand& strand, TransportHandler handler) override;
+    void asyncWrite(const WriteBuffers& buffers, SessionStrand& strand, TransportHandler handler) override;
+    void close() override;
+private:
+    asio::ip::tcp::socket socket;
+};
+
+// 进程内双工通道：对端用 deliver() 推入字节供 Session 读取，Session 写出的字节同步交给 sink，
+// 不经过内核协议栈。sink 在 Session 的 strand 上调用，每次写调用一次。
+class LoopbackTransport : public Transport {
+public:
+    using Sink = std::function<void(const char* data, size_t size)>;
+    LoopbackTransport(asio::any_io_executor executor, Sink sink);
+    asio::any_io_executor getExecutor() override { return executor; }
+    void asyncRead(asio::mutable_buffer buffer, SessionStrand& strand, TransportHandler handler) override;
+    void asyncWrite(const WriteBuffers& buffers, SessionStrand& strand, TransportHandler handler) override;
+    void close() override;
+    // 线程安全，可由模拟驱动在任意线程调用
+    void deliver(const char* data, size_t size);
+    // 对端关闭：挂起的读以 eof 结束
+    void shutdown();
+private:
+    // 需持有 mtx；满足挂起的读时把回调投递到其 strand
+    void completePendingRead();
+
+    asio::any_io_executor executor;
+    Sink sink;
+    std::mutex mtx;
+    std::string inbound;
+    size_t readOffset = 0;
+    bool peerClosed = false;
+    bool closed = false;
+    asio::mutable_buffer pendingBuffer;
+    SessionStrand* pendingStrand = nullptr;
+    TransportHandler pendingHandler;
+};
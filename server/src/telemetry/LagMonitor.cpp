@@ -0,0 +1,96 @@
+#include "LagMonitor.h"
+#include "Metrics.h"
+#include "util/Logger.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+    constexpr size_t max_threads = 256;
+
+    struct ThreadSlot {
+        std::atomic<int64_t> startedNs{0};          // 当前处理的开始时间，0 表示空闲
+        std::atomic<Histogram*> lag{nullptr};       // 注册完成后才非空
+        int64_t warnedStartNs = 0;                  // 只由监控线程读写，同一次处理只告警一次
+    };
+    std::array<ThreadSlot, max_threads> slots;
+    std::atomic<uint32_t> next_thread_index{0};
+
+    int64_t steadyNs(std::chrono::steady_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+    // 每个线程第一次处理请求时注册自己的槽位和直方图，超出 max_threads 的线程不跟踪
+    ThreadSlot* threadSlot() {
+        thread_local ThreadSlot* local = []() -> ThreadSlot* {
+            const uint32_t index = next_thread_index.fetch_add(1, std::memory_order_relaxed);
+            if (index >= max_threads) {
+                return nullptr;
+            }
+            Histogram& histogram = MetricsRegistry::getInstance().histogram("chat_event_loop_lag_seconds",
+                "How long the handler currently running on an io thread has been running, sampled by the lag monitor",
+                MetricsRegistry::latencyBucketsNs(), 1e9, "thread=\"" + std::to_string(index) + "\"");
+            slots[index].lag.store(&histogram, std::memory_order_release);
+            return &slots[index];
+        }();
+        return local;
+    }
+}
+
+LagMonitor::LagMonitor(const LagMonitorConfig& config) : config(config) {}
+LagMonitor::~LagMonitor() {
+    stop();
+}
+void LagMonitor::start() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (running) {
+        return;
+    }
+    running = true;
+    worker = std::thread([this]() { run(); });
+}
+void LagMonitor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        running = false;
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+void LagMonitor::handlerStarted(std::chrono::steady_clock::time_point startedAt) {
+    if (ThreadSlot* slot = threadSlot()) {
+        slot->startedNs.store(steadyNs(startedAt), std::memory_order_relaxed);
+    }
+}
+void LagMonitor::handlerFinished() {
+    if (ThreadSlot* slot = threadSlot()) {
+        slot->startedNs.store(0, std::memory_order_relaxed);
+    }
+}
+void LagMonitor::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!cv.wait_for(lock, config.interval, [this]() { return !running; })) {
+        lock.unlock();
+        sample();
+        lock.lock();
+    }
+}
+void LagMonitor::sample() {
+    const int64_t now = steadyNs(std::chrono::steady_clock::now());
+    const int64_t warnNs = std::chrono::duration_cast<std::chrono::nanoseconds>(config.warnThreshold).count();
+    const uint32_t threads = std::min<uint32_t>(next_thread_index.load(std::memory_order_relaxed), max_threads);
+    for (uint32_t index = 0; index < threads; ++index) {
+        ThreadSlot& slot = slots[index];
+        Histogram* lag = slot.lag.load(std::memory_order_acquire);
+        if (!lag) {
+            continue;
+        }
+        const int64_t started = slot.startedNs.load(std::memory_order_relaxed);
+        const int64_t runningNs = started != 0 && now > started ? now - started : 0;
+        lag->observe(static_cast<uint64_t>(runningNs));
+        if (runningNs > warnNs && slot.warnedStartNs != started) {
+            slot.warnedStartNs = started;
+            LOG_WARN("event_loop_lag", "thread", index, "lag_ms", static_cast<double>(runningNs) / 1e6);
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct LagMonitorConfig {
+    std::chrono::milliseconds interval{100};
+    std::chrono::milliseconds warnThreshold{50};
+};
+
+// 事件循环卡顿检测：每个 io 线程在开始处理一个请求时发布开始时间，处理完清零；
+// 监控线程每个 interval 检查一次各线程当前处理已经运行了多久。
+// 某个处理函数阻塞 io 线程（例如等待数据库连接）时，被阻塞的线程会被直接点名，
+// 不会因为探针被其它空闲线程执行而漏掉。
+// 采样值按线程记入 chat_event_loop_lag_seconds{thread="N"}（空闲为 0），超过阈值时写一次警告日志。
+class LagMonitor {
+public:
+    explicit LagMonitor(const LagMonitorConfig& config);
+    ~LagMonitor();
+    void start();
+    void stop();
+
+    // 由分发路径在当前线程上调用，开销为两次原子写
+    static void handlerStarted(std::chrono::steady_clock::time_point startedAt);
+    static void handlerFinished();
+private:
+    void run();
+    void sample();
+
+    LagMonitorConfig config;
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool running = false;
+};
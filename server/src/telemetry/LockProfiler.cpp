@@ -0,0 +1,139 @@
+#include "LockProfiler.h"
+#include "Metrics.h"
+#include "util/Logger.h"
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace {
+    void updateMax(std::atomic<uint64_t>& slot, uint64_t value) {
+        uint64_t current = slot.load(std::memory_order_relaxed);
+        while (value > current && !slot.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+    double toMs(uint64_t ns) {
+        return static_cast<double>(ns) / 1e6;
+    }
+    std::string baseName(const char* path) {
+        const std::string full(path);
+        const size_t slash = full.find_last_of("/\\");
+        return slash == std::string::npos ? full : full.substr(slash + 1);
+    }
+}
+
+LockStats::LockStats(const std::string& name)
+    : name(name),
+      acquisitions(MetricsRegistry::getInstance().counter("chat_lock_acquisitions_total", "Outermost acquisitions of a profiled mutex", "mutex=\"" + name + "\"")),
+      contended(MetricsRegistry::getInstance().counter("chat_lock_contended_total", "Acquisitions that had to wait for another holder", "mutex=\"" + name + "\"")),
+      wait(MetricsRegistry::getInstance().histogram("chat_lock_wait_seconds", "Time spent waiting to acquire a profiled mutex",
+          MetricsRegistry::latencyBucketsNs(), 1e9, "mutex=\"" + name + "\"")),
+      hold(MetricsRegistry::getInstance().histogram("chat_lock_hold_seconds", "Time a profiled mutex was held",
+          MetricsRegistry::latencyBucketsNs(), 1e9, "mutex=\"" + name + "\"")) {}
+
+void LockStats::onAcquired(bool wasContended, uint64_t waitNs) {
+    acquisitions.inc();
+    if (wasContended) {
+        contended.inc();
+    }
+    wait.observe(waitNs);
+}
+void LockStats::onReleased(const LockSite& site, uint64_t holdNs) {
+    hold.observe(holdNs);
+#if CHAT_LOCK_PROFILING
+    if (!site.file) {
+        return;
+    }
+    // 开放寻址表，槽位由 key 的 CAS 认领，认领者随后写入文件名和行号；表满时丢弃该位置的统计
+    const uint64_t key = (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(site.file)) * 0x9E3779B97F4A7C15ull
+        ^ static_cast<uint64_t>(site.line)) | 1;
+    size_t index = static_cast<size_t>(key >> 32) % site_slots;
+    for (size_t probe = 0; probe < site_slots; ++probe, index = (index + 1) % site_slots) {
+        SiteSlot& slot = sites[index];
+        uint64_t current = slot.key.load(std::memory_order_acquire);
+        if (current == 0 && slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+            slot.line.store(site.line, std::memory_order_relaxed);
+            slot.file.store(site.file, std::memory_order_release);
+            current = key;
+        }
+        if (current == key) {
+            slot.count.fetch_add(1, std::memory_order_relaxed);
+            slot.totalHoldNs.fetch_add(holdNs, std::memory_order_relaxed);
+            updateMax(slot.maxHoldNs, holdNs);
+            return;
+        }
+    }
+#else
+    (void)site;
+#endif
+}
+std::string LockStats::describe() const {
+    std::ostringstream out;
+    const uint64_t total = acquisitions.value();
+    const uint64_t waited = contended.value();
+    out << "mutex " << name << ": acquisitions=" << total << " contended=" << waited;
+    if (total > 0) {
+        out << " (" << 100.0 * static_cast<double>(waited) / static_cast<double>(total) << "%)";
+    }
+    out << "\n  wait ms p50=" << toMs(wait.quantile(0.5)) << " p99=" << toMs(wait.quantile(0.99))
+        << " p999=" << toMs(wait.quantile(0.999))
+        << "\n  hold ms p50=" << toMs(hold.quantile(0.5)) << " p99=" << toMs(hold.quantile(0.99))
+        << " p999=" << toMs(hold.quantile(0.999)) << "\n"
+        << "  top sites by total hold time:\n";
+    for (const SiteRow& row : topSites(10)) {
+        out << "  " << row.site << " count=" << row.count << " total_hold_ms=" << toMs(row.totalHoldNs)
+            << " max_hold_ms=" << toMs(row.maxHoldNs) << "\n";
+    }
+    return out.str();
+}
+void LockStats::logSummary() const {
+    const auto top = topSites(1);
+    LOG_INFO("lock_stats", "mutex", name, "acquisitions", acquisitions.value(), "contended", contended.value(),
+        "wait_p99_ms", toMs(wait.quantile(0.99)), "hold_p99_ms", toMs(hold.quantile(0.99)),
+        "top_site", top.empty() ? std::string("-") : top.front().site);
+}
+std::vector<LockStats::SiteRow> LockStats::topSites(size_t limit) const {
+    std::vector<SiteRow> rows;
+    for (const SiteSlot& slot : sites) {
+        const char* file = slot.file.load(std::memory_order_acquire);
+        if (file) {
+            rows.push_back({ baseName(file) + ":" + std::to_string(slot.line.load(std::memory_order_relaxed)),
+                slot.count.load(std::memory_order_relaxed), slot.totalHoldNs.load(std::memory_order_relaxed),
+                slot.maxHoldNs.load(std::memory_order_relaxed) });
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](const SiteRow& a, const SiteRow& b) { return a.totalHoldNs > b.totalHoldNs; });
+    if (rows.size() > limit) {
+        rows.resize(limit);
+    }
+    return rows;
+}
+
+LockProfiler& LockProfiler::getInstance() {
+    static LockProfiler instance;
+    return instance;
+}
+LockStats& LockProfiler::registerLock(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mtx);
+    locks.emplace_back(name);
+    return locks.back();
+}
+std::string LockProfiler::renderReport() const {
+    if (!enabled) {
+        return "lock profiling is disabled; rebuild with -DCHAT_LOCK_PROFILING=ON\n";
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    std::string report;
+    for (const LockStats& stats : locks) {
+        report += stats.describe();
+    }
+    return report;
+}
+void LockProfiler::logSummary() const {
+    if (!enabled) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const LockStats& stats : locks) {
+        stats.logSummary();
+    }
+}
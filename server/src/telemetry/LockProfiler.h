@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef CHAT_LOCK_PROFILING
+#define CHAT_LOCK_PROFILING 0
+#endif
+
+class Counter;
+class Histogram;
+
+// 加锁位置。开启剖析时由 LockGuard 构造处的默认参数捕获文件名和行号，关闭时为空结构
+#if CHAT_LOCK_PROFILING
+struct LockSite {
+    const char* file = nullptr;
+    int line = 0;
+    static LockSite current(const char* file = __builtin_FILE(), int line = __builtin_LINE()) { return { file, line }; }
+};
+#else
+struct LockSite {
+    static LockSite current() { return {}; }
+};
+#endif
+
+// 一把被剖析的锁的统计：获取次数、竞争次数、等待/持有时间直方图，以及按加锁位置汇总的持有时间
+class LockStats {
+public:
+    explicit LockStats(const std::string& name);
+    void onAcquired(bool contended, uint64_t waitNs);
+    void onReleased(const LockSite& site, uint64_t holdNs);
+    std::string describe() const;
+    // 单行摘要写入日志：次数、竞争率、p99 等待/持有时间以及累计持有最久的位置
+    void logSummary() const;
+private:
+    struct SiteRow {
+        std::string site;
+        uint64_t count;
+        uint64_t totalHoldNs;
+        uint64_t maxHoldNs;
+    };
+    // 按累计持有时间降序，最多 limit 个
+    std::vector<SiteRow> topSites(size_t limit) const;
+    static constexpr size_t site_slots = 256;
+    struct SiteSlot {
+        std::atomic<uint64_t> key{0}; // 文件名指针与行号的组合，0 表示空槽
+        std::atomic<const char*> file{nullptr};
+        std::atomic<int> line{0};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> totalHoldNs{0};
+        std::atomic<uint64_t> maxHoldNs{0};
+    };
+    std::string name;
+    Counter& acquisitions;
+    Counter& contended;
+    Histogram& wait;
+    Histogram& hold;
+    SiteSlot sites[site_slots];
+};
+
+// 进程内所有被剖析的锁，供 /locks 页面和周期日志使用
+class LockProfiler {
+public:
+    static LockProfiler& getInstance();
+    static constexpr bool enabled = CHAT_LOCK_PROFILING != 0;
+    LockStats& registerLock(const std::string& name);
+    std::string renderReport() const;
+    void logSummary() const;
+private:
+    LockProfiler() = default;
+    mutable std::mutex mtx;
+    std::deque<LockStats> locks;
+};
+
+// 可在构建时切换的插桩互斥量。CHAT_LOCK_PROFILING=0 时只是对 Mutex 的转发，没有额外开销。
+// 对递归锁只统计最外层的获取与释放。
+template <class Mutex>
+class ProfiledMutex {
+public:
+#if CHAT_LOCK_PROFILING
+    explicit ProfiledMutex(const char* name) : stats(LockProfiler::getInstance().registerLock(name)) {}
+    void lock(const LockSite& site = {}) {
+        bool contended = false;
+        std::chrono::steady_clock::time_point start;
+        if (!mutex.try_lock()) {
+            contended = true;
+            start = std::chrono::steady_clock::now();
+            mutex.lock();
+        }
+        acquired(site, contended, start);
+    }
+    bool try_lock(const LockSite& site = {}) {
+        if (!mutex.try_lock()) {
+            return false;
+        }
+        acquired(site, false, {});
+        return true;
+    }
+    void unlock() {
+        if (--depth == 0) {
+            stats.onReleased(holder, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - holdStart).count()));
+        }
+        mutex.unlock();
+    }
+private:
+    void acquired(const LockSite& site, bool contended, std::chrono::steady_clock::time_point waitStart) {
+        if (depth++ != 0) {
+            return;
+        }
+        holdStart = std::chrono::steady_clock::now();
+        holder = site;
+        stats.onAcquired(contended, contended
+            ? static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(holdStart - waitStart).count()) : 0);
+    }
+    Mutex mutex;
+    LockStats& stats;
+    // 以下字段只由持锁线程读写
+    int depth = 0;
+    LockSite holder;
+    std::chrono::steady_clock::time_point holdStart;
+#else
+    explicit ProfiledMutex(const char*) {}
+    void lock(const LockSite& = {}) { mutex.lock(); }
+    bool try_lock(const LockSite& = {}) { return mutex.try_lock(); }
+    void unlock() { mutex.unlock(); }
+private:
+    Mutex mutex;
+#endif
+};
+
+// 与 std::lock_guard 用法相同，但把构造处的位置传给 ProfiledMutex；
+// 也满足 BasicLockable，可直接交给 std::condition_variable_any 等待
+template <class Mutex>
+class LockGuard {
+public:
+    explicit LockGuard(Mutex& mutex, LockSite site = LockSite::current()) : mutex(mutex), site(site) { lock(); }
+    ~LockGuard() {
+        if (owns) {
+            mutex.unlock();
+        }
+    }
+    LockGuard(const LockGuard&) = delete;
+    LockGuard& operator=(const LockGuard&) = delete;
+    void lock() {
+        mutex.lock(site);
+        owns = true;
+    }
+    void unlock() {
+        owns = false;
+        mutex.unlock();
+    }
+private:
+    Mutex& mutex;
+    LockSite site;
+    bool owns = false;
+};
+
+// Server::mtx（与 SessionManager、RoomService 共用）和连接池的锁
+using ServerMutex = ProfiledMutex<std::recursive_mutex>;
+using PoolMutex = ProfiledMutex<std::mutex>;
@@ -0,0 +1,222 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace metrics_detail {
+    ThreadShard& localShard() {
+        thread_local ThreadShard* shard = &MetricsRegistry::getInstance().registerThread();
+        return *shard;
+    }
+}
+
+uint64_t Counter::value() const {
+    return MetricsRegistry::getInstance().sumCell(cell);
+}
+
+void Histogram::observe(uint64_t value) {
+    size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+    metrics_detail::add(firstCell + bucket, 1);
+    metrics_detail::add(firstCell + bounds.size() + 1, 1);
+    metrics_detail::add(firstCell + bounds.size() + 2, value);
+}
+uint64_t Histogram::count() const {
+    return MetricsRegistry::getInstance().sumCell(firstCell + bounds.size() + 1);
+}
+uint64_t Histogram::quantile(double q) const {
+    auto& registry = MetricsRegistry::getInstance();
+    std::vector<uint64_t> buckets(bounds.size() + 1);
+    uint64_t total = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        buckets[i] = registry.sumCell(firstCell + i);
+        total += buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const double target = q * static_cast<double>(total);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        cumulative += buckets[i];
+        if (static_cast<double>(cumulative) >= target) {
+            return bounds[i];
+        }
+    }
+    return bounds.empty() ? 0 : bounds.back();
+}
+
+MetricsRegistry& MetricsRegistry::getInstance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+metrics_detail::ThreadShard& MetricsRegistry::registerThread() {
+    // 线程退出后分片仍保留，已经累加的数值不会丢失
+    std::lock_guard<std::mutex> lock(mtx);
+    shards.push_back(std::make_unique<metrics_detail::ThreadShard>());
+    return *shards.back();
+}
+uint64_t MetricsRegistry::sumCell(size_t cell) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    uint64_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard->cells[cell].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+size_t MetricsRegistry::allocateCells(size_t count) {
+    if (nextCell + count > metrics_detail::max_cells) {
+        throw std::runtime_error("MetricsRegistry: out of metric cells.");
+    }
+    size_t first = nextCell;
+    nextCell += count;
+    return first;
+}
+MetricsRegistry::Entry* MetricsRegistry::find(Kind kind, const std::string& name, const std::string& labels) {
+    for (auto& entry : entries) {
+        if (entry.kind == kind && entry.name == name && entry.labels == labels) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (Entry* entry = find(Kind::Counter, name, labels)) {
+        return *entry->counter;
+    }
+    counters.push_back(std::unique_ptr<Counter>(new Counter(allocateCells(1))));
+    entries.push_back(Entry{ Kind::Counter, name, help, labels, counters.back().get(), nullptr, nullptr, nullptr });
+    return *counters.back();
+}
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (Entry* entry = find(Kind::Gauge, name, labels)) {
+        return *entry->gauge;
+    }
+    gauges.push_back(std::unique_ptr<Gauge>(new Gauge()));
+    entries.push_back(Entry{ Kind::Gauge, name, help, labels, nullptr, gauges.back().get(), nullptr, nullptr });
+    return *gauges.back();
+}
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, std::vector<uint64_t> bounds,
+    double scale, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (Entry* entry = find(Kind::Histogram, name, labels)) {
+        return *entry->histogram;
+    }
+    std::sort(bounds.begin(), bounds.end());
+    size_t first = allocateCells(bounds.size() + 3);
+    histograms.push_back(std::unique_ptr<Histogram>(new Histogram(first, std::move(bounds), scale)));
+    entries.push_back(Entry{ Kind::Histogram, name, help, labels, nullptr, nullptr, histograms.back().get(), nullptr });
+    return *histograms.back();
+}
+void MetricsRegistry::gaugeCallback(const std::string& name, const std::string& help, std::function<double()> callback) {
+    addCallback(Kind::GaugeCallback, name, help, std::move(callback));
+}
+void MetricsRegistry::counterCallback(const std::string& name, const std::string& help, std::function<double()> callback) {
+    addCallback(Kind::CounterCallback, name, help, std::move(callback));
+}
+void MetricsRegistry::addCallback(Kind kind, const std::string& name, const std::string& help, std::function<double()> callback) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (Entry* entry = find(kind, name, "")) {
+        entry->callback = std::move(callback);
+        return;
+    }
+    entries.push_back(Entry{ kind, name, help, "", nullptr, nullptr, nullptr, std::move(callback) });
+}
+std::vector<uint64_t> MetricsRegistry::latencyBucketsNs() {
+    // 1us ~ 10s
+    return { 1000, 5000, 10000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000,
+             10000000, 25000000, 50000000, 100000000, 250000000, 500000000, 1000000000, 10000000000ULL };
+}
+std::vector<uint64_t> MetricsRegistry::exponentialBuckets(uint64_t start, uint64_t factor, size_t count) {
+    std::vector<uint64_t> bounds;
+    uint64_t bound = start;
+    for (size_t i = 0; i < count; ++i) {
+        bounds.push_back(bound);
+        bound *= factor;
+    }
+    return bounds;
+}
+void MetricsRegistry::registerProcessMetrics() {
+    gaugeCallback("process_resident_memory_bytes", "Resident memory size in bytes", []() {
+#ifndef _WIN32
+        std::ifstream statm("/proc/self/statm");
+        long long pages = 0, resident = 0;
+        if (statm >> pages >> resident) {
+            return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE));
+        }
+#endif
+        return 0.0;
+    });
+    counterCallback("process_cpu_seconds_total", "CPU time consumed by the process", []() {
+        return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+    });
+}
+std::string MetricsRegistry::renderPrometheus() const {
+    std::vector<const Entry*> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& entry : entries) {
+            snapshot.push_back(&entry);
+        }
+    }
+    // 同一指标族的样本必须连续输出
+    std::stable_sort(snapshot.begin(), snapshot.end(), [](const Entry* a, const Entry* b) { return a->name < b->name; });
+    auto withLabels = [](const std::string& labels, const std::string& extra) {
+        if (labels.empty() && extra.empty()) {
+            return std::string();
+        }
+        if (labels.empty() || extra.empty()) {
+            return "{" + labels + extra + "}";
+        }
+        return "{" + labels + "," + extra + "}";
+    };
+    std::ostringstream out;
+    std::set<std::string> described;
+    for (const Entry* entry : snapshot) {
+        if (described.insert(entry->name).second) {
+            static const char* types[] = { "counter", "gauge", "histogram", "gauge", "counter" };
+            out << "# HELP " << entry->name << " " << entry->help << "\n"
+                << "# TYPE " << entry->name << " " << types[static_cast<int>(entry->kind)] << "\n";
+        }
+        switch (entry->kind) {
+        case Kind::Counter:
+            out << entry->name << withLabels(entry->labels, "") << " " << entry->counter->value() << "\n";
+            break;
+        case Kind::Gauge:
+            out << entry->name << withLabels(entry->labels, "") << " " << entry->gauge->value() << "\n";
+            break;
+        case Kind::GaugeCallback:
+        case Kind::CounterCallback:
+            out << entry->name << " " << entry->callback() << "\n";
+            break;
+        case Kind::Histogram: {
+            const Histogram& h = *entry->histogram;
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i <= h.bounds.size(); ++i) {
+                cumulative += sumCell(h.firstCell + i);
+                std::ostringstream le;
+                if (i < h.bounds.size()) {
+                    le << "le=\"" << static_cast<double>(h.bounds[i]) / h.scale << "\"";
+                }
+                else {
+                    le << "le=\"+Inf\"";
+                }
+                out << entry->name << "_bucket" << withLabels(entry->labels, le.str()) << " " << cumulative << "\n";
+            }
+            out << entry->name << "_sum" << withLabels(entry->labels, "") << " "
+                << static_cast<double>(sumCell(h.firstCell + h.bounds.size() + 2)) / h.scale << "\n";
+            // _count 取各桶之和，与上面的 +Inf 桶一致；单独的计数格与桶不是同一时刻读出的
+            out << entry->name << "_count" << withLabels(entry->labels, "") << " " << cumulative << "\n";
+            break;
+        }
+        }
+    }
+    return out.str();
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 轻量指标：计数器和直方图按线程分片累加，热路径上只有一次 thread_local 查找和一次无锁写入，
+// 抓取时再把各线程的分片求和；仪表盘 (Gauge) 是单个原子变量。
+class MetricsRegistry;
+
+namespace metrics_detail {
+    constexpr size_t max_cells = 8192;
+
+    struct ThreadShard {
+        std::atomic<uint64_t> cells[max_cells] = {};
+    };
+    ThreadShard& localShard();
+
+    // 每个分片只有所属线程写入，用 load + store 代替 fetch_add，避免加锁前缀指令
+    inline void add(size_t cell, uint64_t value) {
+        std::atomic<uint64_t>& slot = localShard().cells[cell];
+        slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+class Counter {
+public:
+    void inc(uint64_t value = 1) { metrics_detail::add(cell, value); }
+    uint64_t value() const;
+private:
+    friend class MetricsRegistry;
+    explicit Counter(size_t cell) : cell(cell) {}
+    size_t cell;
+};
+
+class Gauge {
+public:
+    void set(int64_t v) { current.store(v, std::memory_order_relaxed); }
+    void add(int64_t v) { current.fetch_add(v, std::memory_order_relaxed); }
+    void sub(int64_t v) { current.fetch_sub(v, std::memory_order_relaxed); }
+    int64_t value() const { return current.load(std::memory_order_relaxed); }
+private:
+    friend class MetricsRegistry;
+    Gauge() = default;
+    std::atomic<int64_t> current{0};
+};
+
+// 整数直方图，上界升序排列；输出时除以 scale（例如纳秒记录、以秒输出时 scale = 1e9）
+class Histogram {
+public:
+    void observe(uint64_t value);
+    uint64_t count() const;
+    // 按桶上界估算分位数，q 取 0~1
+    uint64_t quantile(double q) const;
+private:
+    friend class MetricsRegistry;
+    Histogram(size_t firstCell, std::vector<uint64_t> bounds, double scale)
+        : firstCell(firstCell), bounds(std::move(bounds)), scale(scale) {}
+    size_t firstCell; // 依次为 bounds.size() + 1 个桶、count、sum
+    std::vector<uint64_t> bounds;
+    double scale;
+};
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& getInstance();
+
+    // 同名同标签重复注册时返回同一个实例；labels 形如 type="login"
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help, std::vector<uint64_t> bounds,
+        double scale = 1.0, const std::string& labels = "");
+    // 抓取时才计算的指标，例如进程内存
+    void gaugeCallback(const std::string& name, const std::string& help, std::function<double()> callback);
+    // 抓取时才读取的单调递增累计值，例如进程 CPU 时间
+    void counterCallback(const std::string& name, const std::string& help, std::function<double()> callback);
+
+    // 进程级指标（常驻内存等），启动指标服务时注册一次
+    void registerProcessMetrics();
+
+    // Prometheus 文本格式
+    std::string renderPrometheus() const;
+
+    // 常用的桶边界
+    static std::vector<uint64_t> latencyBucketsNs();
+    static std::vector<uint64_t> exponentialBuckets(uint64_t start, uint64_t factor, size_t count);
+
+    uint64_t sumCell(size_t cell) const;
+    metrics_detail::ThreadShard& registerThread();
+private:
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    enum class Kind { Counter, Gauge, Histogram, GaugeCallback, CounterCallback };
+    struct Entry {
+        Kind kind;
+        std::string name;
+        std::string help;
+        std::string labels;
+        Counter* counter = nullptr;
+        Gauge* gauge = nullptr;
+        Histogram* histogram = nullptr;
+        std::function<double()> callback;
+    };
+    Entry* find(Kind kind, const std::string& name, const std::string& labels);
+    void addCallback(Kind kind, const std::string& name, const std::string& help, std::function<double()> callback);
+    size_t allocateCells(size_t count);
+
+    mutable std::mutex mtx;
+    std::vector<std::unique_ptr<metrics_detail::ThreadShard>> shards;
+    std::deque<Entry> entries;
+    std::deque<std::unique_ptr<Counter>> counters;
+    std::deque<std::unique_ptr<Gauge>> gauges;
+    std::deque<std::unique_ptr<Histogram>> histograms;
+    size_t nextCell = 0;
+};
+
+// 作用域计时，析构时把耗时（纳秒）记入直方图
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        histogram.observe(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    }
+private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,76 @@
+#include "MetricsHttpServer.h"
+#include "Metrics.h"
+#include <iostream>
+#include <sstream>
+
+MetricsHttpServer::MetricsHttpServer(asio::io_context& ioc, const std::string& address, unsigned short port)
+    : ioc(ioc), acceptor(ioc, asio::ip::tcp::endpoint(asio::ip::make_address(address), port)) {
+    addRoute("/metrics", "text/plain; version=0.0.4", []() {
+        return MetricsRegistry::getInstance().renderPrometheus();
+    });
+}
+void MetricsHttpServer::addRoute(const std::string& path, const std::string& contentType, Handler handler) {
+    routes[path] = Route{ contentType, std::move(handler) };
+}
+void MetricsHttpServer::start() {
+    std::cout << "[INFO] Metrics endpoint listening on " << acceptor.local_endpoint() << std::endl;
+    start_accept();
+}
+void MetricsHttpServer::stop() {
+    asio::post(ioc, [this]() {
+        asio::error_code ignored;
+        acceptor.close(ignored);
+    });
+}
+void MetricsHttpServer::start_accept() {
+    auto socket = std::make_shared<asio::ip::tcp::socket>(ioc);
+    acceptor.async_accept(*socket, [this, socket](const asio::error_code& ec) {
+        if (!acceptor.is_open()) {
+            return;
+        }
+        if (!ec) {
+            auto request = std::make_shared<asio::streambuf>(8192);
+            asio::async_read_until(*socket, *request, "\r\n\r\n",
+                [this, socket, request](const asio::error_code& ec, size_t) {
+                    if (!ec) {
+                        handle_request(socket, request);
+                    }
+                });
+        }
+        start_accept();
+    });
+}
+void MetricsHttpServer::handle_request(std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<asio::streambuf> request) {
+    std::istream stream(request.get());
+    std::string method, target;
+    stream >> method >> target;
+    std::string path = target.substr(0, target.find('?'));
+
+    std::string status = "200 OK";
+    std::string contentType = "text/plain";
+    std::string body;
+    auto it = routes.find(path);
+    if (method != "GET") {
+        status = "405 Method Not Allowed";
+    }
+    else if (it == routes.end()) {
+        status = "404 Not Found";
+        body = "not found\n";
+    }
+    else {
+        contentType = it->second.contentType;
+        body = it->second.handler();
+    }
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: " << contentType << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    auto payload = std::make_shared<std::string>(response.str());
+    asio::async_write(*socket, asio::buffer(*payload),
+        [socket, payload](const asio::error_code&, size_t) {
+            asio::error_code ignored;
+            socket->shutdown(asio::ip::tcp::socket::shutdown_both, ignored);
+        });
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <asio.hpp>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+// 只监听本地端口的极简 HTTP 服务，每个请求一个短连接。
+// 默认提供 /metrics（Prometheus 文本格式），其他诊断页面通过 addRoute 注册。
+class MetricsHttpServer {
+public:
+    using Handler = std::function<std::string()>;
+
+    MetricsHttpServer(asio::io_context& ioc, const std::string& address, unsigned short port);
+    void addRoute(const std::string& path, const std::string& contentType, Handler handler);
+    void start();
+    void stop();
+private:
+    struct Route {
+        std::string contentType;
+        Handler handler;
+    };
+    void start_accept();
+    void handle_request(std::shared_ptr<asio::ip::tcp::socket> socket, std::shared_ptr<asio::streambuf> request);
+
+    asio::io_context& ioc;
+    asio::ip::tcp::acceptor acceptor;
+    std::map<std::string, Route> routes;
+};
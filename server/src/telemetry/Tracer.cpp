@@ -0,0 +1,132 @@
+#include "Tracer.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <random>
+
+namespace {
+    thread_local TraceContext current_context;
+
+    uint32_t threadIndex() {
+        static std::atomic<uint32_t> next{1};
+        thread_local uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+    uint64_t nextRandom() {
+        thread_local std::mt19937_64 rng(std::random_device{}() ^ (static_cast<uint64_t>(threadIndex()) << 32));
+        return rng();
+    }
+}
+
+Tracer& Tracer::getInstance() {
+    static Tracer instance;
+    return instance;
+}
+int64_t Tracer::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+void Tracer::configure(double sampleRate, size_t eventCapacity) {
+    std::lock_guard<std::mutex> lock(mtx);
+    capacity = std::max<size_t>(eventCapacity, 1);
+    events.clear();
+    events.reserve(capacity);
+    nextSlot = 0;
+    wrapped = false;
+    sampleRate = std::clamp(sampleRate, 0.0, 1.0);
+    sampleThreshold.store(sampleRate >= 1.0 ? std::numeric_limits<uint64_t>::max()
+        : static_cast<uint64_t>(sampleRate * static_cast<double>(std::numeric_limits<uint64_t>::max())),
+        std::memory_order_relaxed);
+}
+TraceContext Tracer::sample(uint64_t sessionId) {
+    TraceContext context;
+    const uint64_t threshold = sampleThreshold.load(std::memory_order_relaxed);
+    if (threshold == 0 || nextRandom() > threshold) {
+        return context;
+    }
+    context.traceId = nextTraceId.fetch_add(1, std::memory_order_relaxed);
+    context.sessionId = sessionId;
+    return context;
+}
+const TraceContext& Tracer::current() {
+    return current_context;
+}
+void Tracer::setCurrent(const TraceContext& context) {
+    current_context = context;
+}
+void Tracer::record(TraceEvent event) {
+    event.threadIndex = threadIndex();
+    std::lock_guard<std::mutex> lock(mtx);
+    if (capacity == 0) {
+        return;
+    }
+    if (events.size() < capacity) {
+        events.push_back(std::move(event));
+    }
+    else {
+        events[nextSlot] = std::move(event);
+        wrapped = true;
+    }
+    nextSlot = (nextSlot + 1) % capacity;
+}
+void Tracer::emit(const char* name, int64_t startUs, int64_t endUs) {
+    const TraceContext& context = current();
+    if (!context) {
+        return;
+    }
+    record(TraceEvent{ name, startUs, endUs - startUs, 0, context, {}, -1 });
+}
+std::string Tracer::renderChromeJson() const {
+    nlohmann::json trace_events = nlohmann::json::array();
+    std::lock_guard<std::mutex> lock(mtx);
+    const size_t count = events.size();
+    const size_t first = wrapped ? nextSlot : 0;
+    for (size_t i = 0; i < count; ++i) {
+        const TraceEvent& event = events[(first + i) % count];
+        nlohmann::json args = {
+            {"trace_id", event.context.traceId},
+            {"session_id", event.context.sessionId},
+        };
+        if (event.context.userId != 0) {
+            args["user_id"] = event.context.userId;
+        }
+        if (event.context.payload) {
+            args["payload"] = event.context.payload;
+        }
+        if (!event.room.empty()) {
+            args["room"] = event.room;
+        }
+        if (event.count >= 0) {
+            args["count"] = event.count;
+        }
+        trace_events.push_back({
+            {"name", event.name},
+            {"cat", "chat"},
+            {"ph", "X"},
+            {"ts", event.startUs},
+            {"dur", event.durationUs},
+            {"pid", 1},
+            {"tid", event.threadIndex},
+            {"args", std::move(args)},
+        });
+    }
+    nlohmann::json document = {
+        {"traceEvents", std::move(trace_events)},
+        {"displayTimeUnit", "ms"},
+    };
+    return document.dump();
+}
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    events.clear();
+    nextSlot = 0;
+    wrapped = false;
+}
+
+TraceSpan::~TraceSpan() {
+    if (!active) {
+        return;
+    }
+    Tracer::getInstance().record(TraceEvent{ name, startUs, Tracer::nowUs() - startUs, 0, Tracer::current(), std::move(room), count });
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 一次被采样请求的上下文：在 Session 读完帧时生成，随 asio::post 传递到分发线程，
+// 之后同一线程上创建的 TraceSpan 都会挂在它下面。traceId 为 0 表示未采样。
+struct TraceContext {
+    uint64_t traceId = 0;
+    uint64_t sessionId = 0;
+    long long userId = 0;
+    const char* payload = nullptr; // Envelope payload 字段名，指向 protobuf 描述符中的字符串
+    explicit operator bool() const { return traceId != 0; }
+};
+
+struct TraceEvent {
+    const char* name;
+    int64_t startUs;
+    int64_t durationUs;
+    uint32_t threadIndex;
+    TraceContext context;
+    std::string room;
+    long long count = -1; // 例如广播的接收人数，-1 表示无
+};
+
+// 采样式请求追踪：各阶段的 span 写入固定容量的内存环形缓冲，
+// 按需导出为 Chrome trace_event JSON，可直接在 Perfetto / chrome://tracing 中打开。
+class Tracer {
+public:
+    static Tracer& getInstance();
+    static int64_t nowUs();
+
+    // sampleRate 为 [0, 1] 的采样比例，0 表示关闭
+    void configure(double sampleRate, size_t capacity);
+    bool isEnabled() const { return sampleThreshold.load(std::memory_order_relaxed) != 0; }
+    // 按采样比例决定是否追踪一个新请求，未命中时返回空上下文
+    TraceContext sample(uint64_t sessionId);
+
+    static const TraceContext& current();
+    static void setCurrent(const TraceContext& context);
+
+    void record(TraceEvent event);
+    // 记录一段已知起止时间的 span，挂在当前线程的上下文下
+    void emit(const char* name, int64_t startUs, int64_t endUs);
+    std::string renderChromeJson() const;
+    void clear();
+private:
+    Tracer() = default;
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    std::atomic<uint64_t> sampleThreshold{0};
+    std::atomic<uint64_t> nextTraceId{1};
+    mutable std::mutex mtx;
+    std::vector<TraceEvent> events;
+    size_t capacity = 0;
+    size_t nextSlot = 0;
+    bool wrapped = false;
+};
+
+// 在作用域内安装追踪上下文，离开时恢复之前的上下文
+class TraceScope {
+public:
+    explicit TraceScope(const TraceContext& context) : previous(Tracer::current()) { Tracer::setCurrent(context); }
+    ~TraceScope() { Tracer::setCurrent(previous); }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+private:
+    TraceContext previous;
+};
+
+// 当前请求被采样时记录一个 span，否则几乎没有开销
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name)
+        : name(name), active(static_cast<bool>(Tracer::current())), startUs(active ? Tracer::nowUs() : 0) {}
+    ~TraceSpan();
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void setRoom(const std::string& roomName) { if (active) room = roomName; }
+    void setCount(long long value) { if (active) count = value; }
+private:
+    const char* name;
+    bool active;
+    int64_t startUs;
+    std::string room;
+    long long count = -1;
+};
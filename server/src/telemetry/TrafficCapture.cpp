@@ -0,0 +1,126 @@
+#include "TrafficCapture.h"
+#include "codec/CaptureFile.h"
+#include "telemetry/Metrics.h"
+#include "util/Logger.h"
+
+namespace {
+    constexpr auto flush_interval = std::chrono::milliseconds(100);
+    constexpr size_t early_flush_bytes = 1024 * 1024;    // 积压超过该值时不等周期，立即唤醒写线程
+    constexpr size_t max_pending_bytes = 8 * 1024 * 1024; // 写线程跟不上时的积压上限，超出的记录丢弃
+
+    Counter& droppedRecords() {
+        static Counter& counter = MetricsRegistry::getInstance().counter("chat_capture_dropped_records_total",
+            "Capture records dropped because the writer fell behind");
+        return counter;
+    }
+}
+
+TrafficCapture& TrafficCapture::getInstance() {
+    static TrafficCapture instance;
+    return instance;
+}
+TrafficCapture::~TrafficCapture() {
+    stop();
+}
+bool TrafficCapture::start(const std::string& path, uint64_t limit) {
+    if (writer.joinable()) {
+        return false;
+    }
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG_ERROR("capture_open_failed", "path", path);
+        return false;
+    }
+    out.write(CaptureFile::magic, sizeof(CaptureFile::magic));
+    startTime = std::chrono::steady_clock::now();
+    maxBytes = limit;
+    writtenBytes = sizeof(CaptureFile::magic);
+    stopping = false;
+    writer = std::thread(&TrafficCapture::run, this);
+    enabled.store(true, std::memory_order_release);
+    LOG_INFO("capture_started", "path", path, "max_bytes", maxBytes);
+    return true;
+}
+void TrafficCapture::stop() {
+    enabled.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+        out.close();
+        LOG_INFO("capture_stopped", "bytes", writtenBytes);
+    }
+}
+void TrafficCapture::record(uint64_t sessionId, const char* body, size_t size) {
+    if (!isEnabled()) {
+        return;
+    }
+    const auto offset = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (pending.size() >= max_pending_bytes) {
+            droppedRecords().inc();
+            return;
+        }
+        const size_t before = pending.size();
+        CaptureFile::appendRecord(pending, static_cast<uint64_t>(offset), sessionId, body, size);
+        wake = before < early_flush_bytes && pending.size() >= early_flush_bytes;
+    }
+    if (wake) {
+        cv.notify_one();
+    }
+}
+void TrafficCapture::recordEnvelope(uint64_t sessionId, const chat::Envelope& envelope, const char* body, size_t size) {
+    if (!isEnabled()) {
+        return;
+    }
+    switch (envelope.payload_case()) {
+    case chat::Envelope::kLoginRequest:
+    case chat::Envelope::kRegistrationRequest:
+    case chat::Envelope::kChangePasswordRequest: {
+        chat::Envelope redacted(envelope);
+        if (redacted.has_login_request()) {
+            redacted.mutable_login_request()->clear_password();
+        } else if (redacted.has_registration_request()) {
+            redacted.mutable_registration_request()->clear_password();
+        } else {
+            redacted.mutable_change_password_request()->clear_old_password();
+            redacted.mutable_change_password_request()->clear_new_password();
+        }
+        const std::string serialized = redacted.SerializeAsString();
+        record(sessionId, serialized.data(), serialized.size());
+        return;
+    }
+    default:
+        record(sessionId, body, size);
+    }
+}
+void TrafficCapture::run() {
+    std::string batch;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cv.wait_for(lock, flush_interval, [this]() { return stopping || pending.size() >= early_flush_bytes; });
+        batch.swap(pending);
+        const bool finished = stopping;
+        lock.unlock();
+        if (!batch.empty()) {
+            out.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            out.flush();
+            writtenBytes += batch.size();
+            batch.clear();
+            if (maxBytes != 0 && writtenBytes >= maxBytes && isEnabled()) {
+                // 只停止采集，剩余缓冲仍会在下一轮写出
+                enabled.store(false, std::memory_order_release);
+                LOG_WARN("capture_limit_reached", "bytes", writtenBytes);
+            }
+        }
+        lock.lock();
+        if (finished && pending.empty()) {
+            return;
+        }
+    }
+}
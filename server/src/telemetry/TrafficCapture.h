@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "chat.pb.h"
+
+// 把每个会话收到的帧按到达时间写入抓包文件（格式见 codec/CaptureFile.h），供 replay 工具重放。
+// IO 线程只把记录追加到内存缓冲，由后台线程批量落盘；写满 maxBytes 后自动停止。
+// 内存缓冲有上限：积压较多时提前唤醒写线程，写线程跟不上时丢弃新记录并计数。
+// 登录、注册和修改密码请求中的密码在写入前清空，抓包文件不含明文密码。
+class TrafficCapture {
+public:
+    static TrafficCapture& getInstance();
+
+    bool start(const std::string& path, uint64_t maxBytes);
+    void stop();
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    void record(uint64_t sessionId, const char* body, size_t size);
+    // body 是 envelope 的序列化结果；带密码的请求清空密码后重新序列化再记录
+    void recordEnvelope(uint64_t sessionId, const chat::Envelope& envelope, const char* body, size_t size);
+    void recordClose(uint64_t sessionId) { record(sessionId, nullptr, 0); }
+private:
+    TrafficCapture() = default;
+    ~TrafficCapture();
+    TrafficCapture(const TrafficCapture&) = delete;
+    TrafficCapture& operator=(const TrafficCapture&) = delete;
+    void run();
+
+    std::atomic<bool> enabled{false};
+    std::chrono::steady_clock::time_point startTime;
+    uint64_t maxBytes = 0;
+    uint64_t writtenBytes = 0;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::string pending;
+    bool stopping = false;
+    std::ofstream out;
+    std::thread writer;
+};
@@ -0,0 +1,168 @@
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+    constexpr size_t ring_capacity = 4096; // 2 的幂
+    constexpr const char* level_names[] = { "DEBUG", "INFO ", "WARN ", "ERROR" };
+
+    int64_t nowUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+// 单生产者（所属线程）单消费者（后台线程）的环形缓冲
+struct Logger::Ring {
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+    uint32_t threadIndex = 0;
+    std::unique_ptr<LogRecord[]> records{new LogRecord[ring_capacity]};
+};
+
+std::atomic<LogLevel> Logger::runtimeLevel{LogLevel::Info};
+
+void LogWriter::value(double v) {
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "%.6g", v);
+    raw(std::string_view(buf, n > 0 ? static_cast<size_t>(n) : 0));
+}
+
+Logger& Logger::getInstance() {
+    static Logger instance;
+    return instance;
+}
+Logger::~Logger() {
+    stop();
+}
+LogLevel Logger::parseLevel(const std::string& name) {
+    if (name == "debug") return LogLevel::Debug;
+    if (name == "warn") return LogLevel::Warn;
+    if (name == "error") return LogLevel::Error;
+    if (name == "off") return LogLevel::Off;
+    return LogLevel::Info;
+}
+bool Logger::start(const std::string& path, LogLevel level) {
+    if (running.load()) {
+        return true;
+    }
+    if (path.empty()) {
+        output = stdout;
+        ownsOutput = false;
+    }
+    else {
+        output = std::fopen(path.c_str(), "a");
+        if (!output) {
+            std::fprintf(stderr, "Logger Error: Could not open log file '%s'.\n", path.c_str());
+            output = stdout;
+            ownsOutput = false;
+        }
+        else {
+            ownsOutput = true;
+        }
+    }
+    setLevel(level);
+    running.store(true);
+    worker = std::thread([this]() { run(); });
+    return true;
+}
+void Logger::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+    std::string out;
+    drain(out);
+    if (!out.empty()) {
+        std::fwrite(out.data(), 1, out.size(), output);
+    }
+    std::fflush(output);
+    if (ownsOutput) {
+        std::fclose(output);
+    }
+    output = nullptr;
+}
+uint64_t Logger::getDroppedCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    uint64_t total = 0;
+    for (const auto& ring : rings) {
+        total += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+Logger::Ring& Logger::registerThread() {
+    std::lock_guard<std::mutex> lock(mtx);
+    rings.push_back(std::make_unique<Ring>());
+    rings.back()->threadIndex = static_cast<uint32_t>(rings.size() - 1);
+    return *rings.back();
+}
+Logger::Ring& Logger::localRing() {
+    thread_local Ring* ring = &getInstance().registerThread();
+    return *ring;
+}
+LogRecord* Logger::beginRecord(LogLevel level) {
+    Ring& ring = localRing();
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= ring_capacity) {
+        ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    LogRecord& record = ring.records[head & (ring_capacity - 1)];
+    record.timestampUs = nowUs();
+    record.level = level;
+    return &record;
+}
+void Logger::commitRecord() {
+    Ring& ring = localRing();
+    ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+size_t Logger::drain(std::string& out) {
+    std::vector<Ring*> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& ring : rings) {
+            snapshot.push_back(ring.get());
+        }
+    }
+    size_t drained = 0;
+    for (Ring* ring : snapshot) {
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail, ++drained) {
+            const LogRecord& record = ring->records[tail & (ring_capacity - 1)];
+            std::time_t seconds = static_cast<std::time_t>(record.timestampUs / 1000000);
+            std::tm tm{};
+#ifdef _WIN32
+            gmtime_s(&tm, &seconds);
+#else
+            gmtime_r(&seconds, &tm);
+#endif
+            char prefix[64];
+            int n = std::snprintf(prefix, sizeof(prefix), "%04d-%02d-%02dT%02d:%02d:%02d.%06lldZ %s [t%u] ",
+                tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                static_cast<long long>(record.timestampUs % 1000000),
+                level_names[static_cast<int>(record.level)], ring->threadIndex);
+            out.append(prefix, n > 0 ? static_cast<size_t>(n) : 0);
+            out.append(record.text, record.length);
+            out.push_back('\n');
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    return drained;
+}
+void Logger::run() {
+    std::string batch;
+    while (running.load(std::memory_order_relaxed)) {
+        batch.clear();
+        if (drain(batch) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        std::fwrite(batch.data(), 1, batch.size(), output);
+        std::fflush(output);
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class LogLevel : uint8_t { Debug = 0, Info = 1, Warn = 2, Error = 3, Off = 4 };
+
+// 编译期最低日志级别，低于它的日志调用在编译期被整体去除（默认去除 Debug）
+#ifndef CHAT_LOG_COMPILE_LEVEL
+#define CHAT_LOG_COMPILE_LEVEL 1
+#endif
+
+// 结构化日志：LOG_INFO("event", "key1", value1, "key2", value2, ...)
+// 调用线程直接格式化到本线程的无锁环形缓冲，后台线程批量写出；缓冲满时丢弃并计数。
+#define CHAT_LOG(level, ...)                                                              \
+    do {                                                                                  \
+        if (static_cast<int>(level) >= CHAT_LOG_COMPILE_LEVEL && Logger::isEnabled(level)) \
+            Logger::log(level, __VA_ARGS__);                                              \
+    } while (0)
+#define LOG_DEBUG(...) CHAT_LOG(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) CHAT_LOG(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...) CHAT_LOG(LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) CHAT_LOG(LogLevel::Error, __VA_ARGS__)
+
+struct LogRecord {
+    static constexpr size_t text_capacity = 240;
+    int64_t timestampUs;
+    LogLevel level;
+    uint16_t length;
+    char text[text_capacity];
+};
+
+// 把事件名与键值对以 logfmt 形式写入一条记录，超长部分截断
+class LogWriter {
+public:
+    explicit LogWriter(LogRecord& record) : record(record) { record.length = 0; }
+    void raw(std::string_view text) {
+        size_t n = std::min(text.size(), LogRecord::text_capacity - record.length);
+        std::memcpy(record.text + record.length, text.data(), n);
+        record.length = static_cast<uint16_t>(record.length + n);
+    }
+    void value(std::string_view text) {
+        bool quote = text.empty() || text.find_first_of(" =\"") != std::string_view::npos;
+        if (quote) raw("\"");
+        raw(text);
+        if (quote) raw("\"");
+    }
+    void value(const char* text) { value(std::string_view(text ? text : "")); }
+    void value(const std::string& text) { value(std::string_view(text)); }
+    void value(bool v) { raw(v ? "true" : "false"); }
+    void value(char c) { value(std::string_view(&c, 1)); }
+    void value(double v);
+    template<class T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    void value(T v) {
+        char buf[24];
+        auto result = std::to_chars(buf, buf + sizeof(buf), v);
+        raw(std::string_view(buf, result.ptr - buf));
+    }
+    template<class T, std::enable_if_t<std::is_enum_v<T>, int> = 0>
+    void value(T v) { value(static_cast<std::underlying_type_t<T>>(v)); }
+private:
+    LogRecord& record;
+};
+
+class Logger {
+public:
+    static Logger& getInstance();
+    static LogLevel parseLevel(const std::string& name);
+
+    // path 为空时写到标准输出
+    bool start(const std::string& path, LogLevel level);
+    void stop();
+    static void setLevel(LogLevel level) { runtimeLevel.store(level, std::memory_order_relaxed); }
+    static bool isEnabled(LogLevel level) { return level >= runtimeLevel.load(std::memory_order_relaxed); }
+    uint64_t getDroppedCount() const;
+
+    template<class... Fields>
+    static void log(LogLevel level, const char* event, const Fields&... fields) {
+        static_assert(sizeof...(Fields) % 2 == 0, "log fields must be key/value pairs");
+        LogRecord* record = beginRecord(level);
+        if (!record) {
+            return;
+        }
+        LogWriter writer(*record);
+        writer.raw(event);
+        writeFields(writer, fields...);
+        commitRecord();
+    }
+private:
+    struct Ring;
+
+    Logger() = default;
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    static LogRecord* beginRecord(LogLevel level);
+    static void commitRecord();
+    static Ring& localRing();
+    Ring& registerThread();
+    void run();
+    size_t drain(std::string& out);
+
+    static void writeFields(LogWriter&) {}
+    template<class Key, class Value, class... Rest>
+    static void writeFields(LogWriter& writer, const Key& key, const Value& value, const Rest&... rest) {
+        writer.raw(" ");
+        writer.raw(key);
+        writer.raw("=");
+        writer.value(value);
+        writeFields(writer, rest...);
+    }
+
+    static std::atomic<LogLevel> runtimeLevel;
+    mutable std::mutex mtx;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::FILE* output = nullptr;
+    bool ownsOutput = false;
+};
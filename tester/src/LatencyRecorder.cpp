@@ -0,0 +1,82 @@
+#include "LatencyRecorder.h"
+#include <hdr/hdr_histogram.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+LatencyRecorder::LatencyRecorder(int64_t highestUs, int significantFigures) : highestUs(highestUs) {
+    if (hdr_init(1, highestUs, significantFigures, &histogram) != 0) {
+        throw std::runtime_error("Failed to allocate latency histogram");
+    }
+}
+LatencyRecorder::~LatencyRecorder() {
+    hdr_close(histogram);
+}
+void LatencyRecorder::record(int64_t latencyUs) {
+    hdr_record_value_atomic(histogram, std::clamp<int64_t>(latencyUs, 1, highestUs));
+}
+int64_t LatencyRecorder::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+LatencyRecorder::Summary LatencyRecorder::summarize() const {
+    Summary summary;
+    summary.count = histogram->total_count;
+    if (summary.count == 0) {
+        return summary;
+    }
+    summary.mean = hdr_mean(histogram);
+    summary.p50 = hdr_value_at_percentile(histogram, 50.0);
+    summary.p99 = hdr_value_at_percentile(histogram, 99.0);
+    summary.p999 = hdr_value_at_percentile(histogram, 99.9);
+    summary.max = hdr_max(histogram);
+    return summary;
+}
+
+void LatencyReport::printText(std::ostream& out) const {
+    const double seconds = durationSeconds > 0 ? durationSeconds : 1.0;
+    out << "--- Latency Summary" << (label.empty() ? "" : " (" + label + ")") << " ---\n";
+    if (targetRate > 0) {
+        out << "Target Rate: " << targetRate << " msg/s\n";
+    }
+    out << "Send Throughput: " << messagesSent / seconds << " msg/s\n"
+        << "Delivery Throughput: " << messagesReceived / seconds << " msg/s\n"
+        << "Latency Samples: " << latency.count << "\n"
+        << "p50: " << latency.p50 << " us\n"
+        << "p99: " << latency.p99 << " us\n"
+        << "p99.9: " << latency.p999 << " us\n"
+        << "max: " << latency.max << " us\n"
+        << "-----------------------\n";
+}
+std::string LatencyReport::toJson() const {
+    const double seconds = durationSeconds > 0 ? durationSeconds : 1.0;
+    std::ostringstream out;
+    out << "{\"label\":\"" << label << "\""
+        << ",\"duration_s\":" << durationSeconds
+        << ",\"target_rate\":" << targetRate
+        << ",\"messages_sent\":" << messagesSent
+        << ",\"messages_received\":" << messagesReceived
+        << ",\"send_throughput\":" << messagesSent / seconds
+        << ",\"delivery_throughput\":" << messagesReceived / seconds
+        << ",\"latency_us\":{\"count\":" << latency.count
+        << ",\"mean\":" << latency.mean
+        << ",\"p50\":" << latency.p50
+        << ",\"p99\":" << latency.p99
+        << ",\"p99_9\":" << latency.p999
+        << ",\"max\":" << latency.max << "}}";
+    return out.str();
+}
+bool writeReportsJson(const std::string& path, const std::vector<LatencyReport>& reports) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return false;
+    }
+    out << "[";
+    for (size_t i = 0; i < reports.size(); ++i) {
+        out << (i ? ",\n " : "") << reports[i].toJson();
+    }
+    out << "]\n";
+    return true;
+}
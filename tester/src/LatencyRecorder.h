@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct hdr_histogram;
+
+// 基于 HdrHistogram 的延迟记录器（单位微秒），多个 io 线程可以并发记录
+class LatencyRecorder {
+public:
+    struct Summary {
+        int64_t count = 0;
+        double mean = 0;
+        int64_t p50 = 0;
+        int64_t p99 = 0;
+        int64_t p999 = 0;
+        int64_t max = 0;
+    };
+
+    explicit LatencyRecorder(int64_t highestUs = 60'000'000, int significantFigures = 3);
+    ~LatencyRecorder();
+    LatencyRecorder(const LatencyRecorder&) = delete;
+    LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+
+    void record(int64_t latencyUs);
+    // 同一进程内所有客户端共用的单调时钟，写入消息的 client_timestamp_us
+    static int64_t nowUs();
+    Summary summarize() const;
+private:
+    hdr_histogram* histogram = nullptr;
+    int64_t highestUs;
+};
+
+// 一次压测（或扫描中的一步）的结果
+struct LatencyReport {
+    std::string label;
+    double durationSeconds = 0;
+    double targetRate = 0; // 开环模式下的目标速率，0 表示闭环
+    long long messagesSent = 0;
+    long long messagesReceived = 0;
+    LatencyRecorder::Summary latency;
+
+    void printText(std::ostream& out) const;
+    std::string toJson() const;
+};
+
+bool writeReportsJson(const std::string& path, const std::vector<LatencyReport>& reports);
@@ -0,0 +1,280 @@
+#include "LeanClient.h"
+#include "codec/FrameCodec.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr uint32_t max_body_length = 8192;
+
+    long long selfResidentBytes() {
+#ifdef _WIN32
+        return 0;
+#else
+        std::ifstream statm("/proc/self/statm");
+        long long pages = 0, resident = 0;
+        statm >> pages >> resident;
+        return resident * sysconf(_SC_PAGESIZE);
+#endif
+    }
+    // 从服务器的 /metrics 中读取 process_resident_memory_bytes，失败返回 -1
+    long long serverResidentBytes(const std::string& endpoint) {
+        const auto colon = endpoint.rfind(':');
+        if (endpoint.empty() || colon == std::string::npos) {
+            return -1;
+        }
+        try {
+            asio::io_context ioc;
+            asio::ip::tcp::socket socket(ioc);
+            asio::ip::tcp::resolver resolver(ioc);
+            asio::connect(socket, resolver.resolve(endpoint.substr(0, colon), endpoint.substr(colon + 1)));
+            const std::string request = "GET /metrics HTTP/1.0\r\nHost: " + endpoint + "\r\n\r\n";
+            asio::write(socket, asio::buffer(request));
+            std::string response;
+            asio::error_code ec;
+            asio::read(socket, asio::dynamic_buffer(response), ec);
+            const std::string key = "\nprocess_resident_memory_bytes ";
+            const auto pos = response.find(key);
+            if (pos == std::string::npos) {
+                return -1;
+            }
+            return static_cast<long long>(std::stod(response.substr(pos + key.size())));
+        }
+        catch (const std::exception&) {
+            return -1;
+        }
+    }
+}
+
+LeanClient::LeanClient(asio::io_context& ioc, uint32_t index, const LeanOptions& options, LeanCounters& counters)
+    : socket(ioc), options(options), counters(counters), index(index) {}
+
+void LeanClient::connect(const asio::ip::tcp::endpoint& server, const asio::ip::address* source) {
+    asio::error_code ec;
+    socket.open(server.protocol(), ec);
+    if (!ec && source) {
+        socket.bind(asio::ip::tcp::endpoint(*source, 0), ec);
+    }
+    if (ec) {
+        fail();
+        return;
+    }
+    socket.async_connect(server, [this](const asio::error_code& ec) {
+        if (ec) {
+            fail();
+            return;
+        }
+        ++counters.connected;
+        socket.set_option(asio::ip::tcp::no_delay(true));
+        chat::Envelope envelope;
+        envelope.mutable_registration_request()->set_username(username());
+        envelope.mutable_registration_request()->set_password("123456");
+        write(envelope);
+        read_header();
+    });
+}
+void LeanClient::close() {
+    asio::post(socket.get_executor(), [this]() {
+        asio::error_code ignored;
+        socket.close(ignored);
+    });
+}
+void LeanClient::fail() {
+    if (!failed) {
+        failed = true;
+        if (authenticated) {
+            ++counters.closed;
+        }
+        else {
+            ++counters.failed;
+        }
+    }
+    asio::error_code ignored;
+    socket.close(ignored);
+}
+void LeanClient::read_header() {
+    asio::async_read(socket, asio::buffer(header), [this](const asio::error_code& ec, size_t) {
+        if (ec) {
+            if (ec != asio::error::operation_aborted) {
+                fail();
+            }
+            return;
+        }
+        bool compressed = false;
+        const uint32_t length = FrameCodec::readHeader(header, compressed);
+        if (length == 0 || length >= max_body_length || compressed) {
+            fail();
+            return;
+        }
+        read_body(length);
+    });
+}
+void LeanClient::read_body(uint32_t length) {
+    body.resize(length);
+    asio::async_read(socket, asio::buffer(body), [this](const asio::error_code& ec, size_t) {
+        if (ec) {
+            if (ec != asio::error::operation_aborted) {
+                fail();
+            }
+            return;
+        }
+        chat::Envelope envelope;
+        if (!envelope.ParseFromString(body)) {
+            fail();
+            return;
+        }
+        // 空闲连接只会收到很小的帧，避免偶尔的大帧让缓冲常驻
+        if (body.capacity() > 256) {
+            std::string().swap(body);
+        }
+        handle(envelope);
+        read_header();
+    });
+}
+void LeanClient::handle(const chat::Envelope& envelope) {
+    switch (envelope.payload_case()) {
+        case chat::Envelope::kRegistrationResponse: {
+            // 账号已存在时同样直接登录
+            chat::Envelope login;
+            login.mutable_login_request()->set_username(username());
+            login.mutable_login_request()->set_password("123456");
+            write(login);
+            break;
+        }
+        case chat::Envelope::kLoginResponse:
+            if (!envelope.login_response().success()) {
+                fail();
+                break;
+            }
+            authenticated = true;
+            ++counters.authenticated;
+            if (!options.room.empty()) {
+                chat::Envelope join;
+                join.mutable_room_operation_request()->set_operation(chat::RoomOperation::JOIN);
+                join.mutable_room_operation_request()->set_room_name(options.room);
+                write(join);
+            }
+            break;
+        case chat::Envelope::kPing: {
+            chat::Envelope pong;
+            pong.mutable_pong()->set_timestamp_ms(envelope.ping().timestamp_ms());
+            write(pong);
+            break;
+        }
+        default:
+            break;
+    }
+}
+void LeanClient::write(const chat::Envelope& envelope) {
+    std::string frame = FrameCodec::encode(envelope.SerializeAsString());
+    if (writing) {
+        pending += frame;
+        return;
+    }
+    outbox = std::move(frame);
+    do_write();
+}
+void LeanClient::do_write() {
+    writing = true;
+    asio::async_write(socket, asio::buffer(outbox), [this](const asio::error_code& ec, size_t) {
+        writing = false;
+        if (ec) {
+            if (ec != asio::error::operation_aborted) {
+                fail();
+            }
+            return;
+        }
+        if (!pending.empty()) {
+            outbox.swap(pending);
+            pending.clear();
+            do_write();
+        }
+        else {
+            std::string().swap(outbox);
+        }
+    });
+}
+
+int runLeanMode(const LeanOptions& options) {
+    asio::ip::tcp::endpoint server;
+    try {
+        asio::io_context resolver_context;
+        asio::ip::tcp::resolver resolver(resolver_context);
+        server = *resolver.resolve(options.host, std::to_string(options.port)).begin();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Failed to resolve " << options.host << ": " << e.what() << "\n";
+        return 1;
+    }
+    const int thread_count = options.threads > 0 ? options.threads : 1;
+    std::vector<std::unique_ptr<asio::io_context>> contexts;
+    std::vector<asio::executor_work_guard<asio::io_context::executor_type>> guards;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        contexts.push_back(std::make_unique<asio::io_context>(1));
+        guards.push_back(asio::make_work_guard(*contexts.back()));
+    }
+    for (auto& context : contexts) {
+        threads.emplace_back([ioc = context.get()]() { ioc->run(); });
+    }
+
+    LeanCounters counters;
+    const long long server_rss_before = serverResidentBytes(options.metricsEndpoint);
+    const long long self_rss_before = selfResidentBytes();
+    auto print_status = [&]() {
+        std::cout << "Connected: " << counters.connected << ", Authenticated: " << counters.authenticated
+            << ", Failed: " << counters.failed << ", Dropped: " << counters.closed
+            << ", Tester RSS: " << selfResidentBytes() / (1024 * 1024) << " MiB" << std::endl;
+    };
+
+    std::vector<std::unique_ptr<LeanClient>> clients;
+    clients.reserve(options.connections);
+    const auto interval = std::chrono::duration<double>(1.0 / (options.connectRate > 0 ? options.connectRate : 1.0));
+    const auto ramp_start = std::chrono::steady_clock::now();
+    auto last_status = ramp_start;
+    for (int i = 0; i < options.connections; ++i) {
+        asio::io_context& ioc = *contexts[i % contexts.size()];
+        clients.push_back(std::make_unique<LeanClient>(ioc, static_cast<uint32_t>(i), options, counters));
+        LeanClient* client = clients.back().get();
+        const asio::ip::address* source = options.sourceAddresses.empty()
+            ? nullptr : &options.sourceAddresses[i % options.sourceAddresses.size()];
+        asio::post(ioc, [client, server, source]() { client->connect(server, source); });
+        // 按目标速率匀速建连，落后时不补发突发
+        std::this_thread::sleep_until(ramp_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval * (i + 1)));
+        if (std::chrono::steady_clock::now() - last_status >= std::chrono::seconds(1)) {
+            last_status = std::chrono::steady_clock::now();
+            print_status();
+        }
+    }
+    std::cout << "Ramp finished. Holding " << options.connections << " connections for " << options.holdSeconds << " seconds...\n";
+    for (int i = 0; i < options.holdSeconds; ++i) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        print_status();
+    }
+
+    const long long server_rss_after = serverResidentBytes(options.metricsEndpoint);
+    const long long self_rss_after = selfResidentBytes();
+    const int sessions = counters.authenticated - counters.closed;
+    std::cout << "--- Connection Summary ---\n"
+        << "Authenticated Sessions: " << sessions << "\n"
+        << "Failed Connections: " << counters.failed << "\n"
+        << "Tester Memory: " << (sessions > 0 ? (self_rss_after - self_rss_before) / sessions : 0) << " B/connection\n";
+    if (server_rss_before >= 0 && server_rss_after >= 0) {
+        std::cout << "Server RSS: " << server_rss_before / (1024 * 1024) << " -> " << server_rss_after / (1024 * 1024) << " MiB\n"
+            << "Server Memory: " << (sessions > 0 ? (server_rss_after - server_rss_before) / sessions : 0) << " B/connection\n";
+    }
+    std::cout << "--------------------------\n";
+
+    for (auto& client : clients) {
+        client->close();
+    }
+    guards.clear();
+    for (auto& t : threads) {
+        t.join();
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <asio.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "chat.pb.h"
+
+struct LeanOptions {
+    std::string host;
+    unsigned short port = 0;
+    int connections = 0;
+    int threads = 1;
+    std::vector<asio::ip::address> sourceAddresses; // 轮流绑定，避免单个源地址的临时端口耗尽
+    double connectRate = 1000;                      // 每秒新建连接数
+    int holdSeconds = 60;
+    std::string userPrefix = "lean";
+    std::string room;                               // 为空则登录后保持空闲，不加入房间
+    std::string metricsEndpoint;                    // host:port，用于读取服务器 RSS
+};
+
+struct LeanCounters {
+    std::atomic<int> connected{0};
+    std::atomic<int> authenticated{0};
+    std::atomic<int> failed{0};
+    std::atomic<int> closed{0};
+};
+
+// 高连接数模式下的最小客户端：没有 work_guard、没有 shared_ptr 控制块、不保存用户名，
+// 只处理注册/登录/加入房间和心跳。所有回调都在所属 io_context 的唯一线程上执行。
+class LeanClient {
+public:
+    LeanClient(asio::io_context& ioc, uint32_t index, const LeanOptions& options, LeanCounters& counters);
+    void connect(const asio::ip::tcp::endpoint& server, const asio::ip::address* source);
+    void close();
+private:
+    std::string username() const { return options.userPrefix + "_" + std::to_string(index); }
+    void read_header();
+    void read_body(uint32_t length);
+    void handle(const chat::Envelope& envelope);
+    void write(const chat::Envelope& envelope);
+    void do_write();
+    void fail();
+
+    asio::ip::tcp::socket socket;
+    const LeanOptions& options;
+    LeanCounters& counters;
+    std::array<char, 4> header;
+    bool writing = false;
+    bool authenticated = false;
+    bool failed = false;
+    uint32_t index;
+    std::string body;
+    std::string outbox;  // 正在发送的帧
+    std::string pending; // 发送期间新产生的帧，下一次一起发出
+};
+
+// 按 options 建立并保持大量空闲但已认证的连接，报告服务器每连接内存占用
+int runLeanMode(const LeanOptions& options);
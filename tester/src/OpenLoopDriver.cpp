@@ -0,0 +1,109 @@
+#include "OpenLoopDriver.h"
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+OpenLoopDriver::OpenLoopDriver(std::vector<double> stepRates, std::chrono::milliseconds stepDuration)
+    : rates(std::move(stepRates)),
+      stepUs(std::chrono::duration_cast<std::chrono::microseconds>(stepDuration).count()),
+      sent(rates.size(), 0),
+      delivered(new std::atomic<long long>[rates.size()]) {
+    for (size_t i = 0; i < rates.size(); ++i) {
+        if (rates[i] <= 0) {
+            throw std::invalid_argument("Open-loop rate must be positive");
+        }
+        delivered[i] = 0;
+        recorders.push_back(std::make_unique<LatencyRecorder>());
+    }
+}
+void OpenLoopDriver::run(const SendFn& send, std::chrono::seconds drain) {
+    uint64_t sequence = 0;
+    const int64_t begin = LatencyRecorder::nowUs();
+    startUs.store(begin, std::memory_order_release);
+    for (size_t step = 0; step < rates.size(); ++step) {
+        const double interval = 1e6 / rates[step];
+        const int64_t stepEnd = begin + static_cast<int64_t>(step + 1) * stepUs;
+        double next = static_cast<double>(begin + static_cast<int64_t>(step) * stepUs);
+        while (next < stepEnd) {
+            const int64_t now = LatencyRecorder::nowUs();
+            if (next > now) {
+                std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(next) - now));
+                continue;
+            }
+            // 把到期的消息一次发完，每条仍带各自的预定发送时刻
+            while (next <= now && next < stepEnd) {
+                send(sequence++, static_cast<int64_t>(next));
+                ++sent[step];
+                next += interval;
+            }
+        }
+    }
+    std::this_thread::sleep_for(drain);
+}
+void OpenLoopDriver::recordDelivery(int64_t intendedUs, int64_t receivedUs) {
+    const int64_t begin = startUs.load(std::memory_order_acquire);
+    if (begin == 0 || intendedUs < begin) {
+        return;
+    }
+    const size_t step = static_cast<size_t>((intendedUs - begin) / stepUs);
+    if (step >= rates.size()) {
+        return;
+    }
+    recorders[step]->record(receivedUs - intendedUs);
+    delivered[step].fetch_add(1, std::memory_order_relaxed);
+}
+std::vector<LatencyReport> OpenLoopDriver::getReports() const {
+    std::vector<LatencyReport> reports;
+    for (size_t i = 0; i < rates.size(); ++i) {
+        LatencyReport report;
+        std::ostringstream label;
+        label << "rate=" << rates[i];
+        report.label = label.str();
+        report.durationSeconds = stepUs / 1e6;
+        report.targetRate = rates[i];
+        report.messagesSent = sent[i];
+        report.messagesReceived = delivered[i].load(std::memory_order_relaxed);
+        report.latency = recorders[i]->summarize();
+        reports.push_back(std::move(report));
+    }
+    return reports;
+}
+std::vector<double> OpenLoopDriver::parseSweep(const std::string& spec) {
+    double start = 0, end = 0, step = 0;
+    char sep1 = 0, sep2 = 0;
+    std::istringstream in(spec);
+    if (!(in >> start >> sep1 >> end >> sep2 >> step) || sep1 != ':' || sep2 != ':' || start <= 0 || step <= 0 || end < start) {
+        throw std::invalid_argument("Invalid sweep spec '" + spec + "', expected start:end:step");
+    }
+    std::vector<double> result;
+    for (double rate = start; rate <= end + 1e-9; rate += step) {
+        result.push_back(rate);
+    }
+    return result;
+}
+std::vector<double> OpenLoopDriver::rampTo(double rate, int steps) {
+    std::vector<double> result;
+    steps = steps > 0 ? steps : 1;
+    for (int i = 1; i <= steps; ++i) {
+        result.push_back(rate * i / steps);
+    }
+    return result;
+}
+void OpenLoopDriver::printCurve(std::ostream& out, const std::vector<LatencyReport>& reports) {
+    out << "--- Throughput vs Latency ---\n"
+        << std::setw(12) << "target/s" << std::setw(12) << "sent/s" << std::setw(14) << "delivered/s"
+        << std::setw(10) << "p50(us)" << std::setw(10) << "p99(us)" << std::setw(12) << "p99.9(us)" << std::setw(12) << "max(us)" << "\n";
+    for (const auto& report : reports) {
+        const double seconds = report.durationSeconds > 0 ? report.durationSeconds : 1.0;
+        out << std::setw(12) << report.targetRate
+            << std::setw(12) << static_cast<long long>(report.messagesSent / seconds)
+            << std::setw(14) << static_cast<long long>(report.messagesReceived / seconds)
+            << std::setw(10) << report.latency.p50
+            << std::setw(10) << report.latency.p99
+            << std::setw(12) << report.latency.p999
+            << std::setw(12) << report.latency.max << "\n";
+    }
+    out << "-----------------------------\n";
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "LatencyRecorder.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 开环恒定速率负载：每条消息的发送时刻按目标速率预先确定，发送线程落后时立即补发，
+// 延迟从预定发送时刻算起，服务器卡顿造成的排队会完整体现在分位数里（修正协调遗漏）。
+// 每个速率为一步，依次执行，每步单独统计，用于画出吞吐-延迟曲线。
+class OpenLoopDriver {
+public:
+    using SendFn = std::function<void(uint64_t sequence, int64_t intendedUs)>;
+
+    OpenLoopDriver(std::vector<double> rates, std::chrono::milliseconds stepDuration);
+
+    // 阻塞执行所有步骤，最后等待 drain 时间让在途消息到达
+    void run(const SendFn& send, std::chrono::seconds drain = std::chrono::seconds(2));
+    // 接收端调用，按预定发送时刻归属到对应的步骤
+    void recordDelivery(int64_t intendedUs, int64_t receivedUs);
+    std::vector<LatencyReport> getReports() const;
+
+    // "start:end:step"，例如 "1000:20000:1000"
+    static std::vector<double> parseSweep(const std::string& spec);
+    // 在 steps 步内线性升到 rate
+    static std::vector<double> rampTo(double rate, int steps);
+    static void printCurve(std::ostream& out, const std::vector<LatencyReport>& reports);
+private:
+    std::vector<double> rates;
+    int64_t stepUs;
+    std::atomic<int64_t> startUs{0};
+    std::vector<long long> sent;
+    std::unique_ptr<std::atomic<long long>[]> delivered;
+    std::vector<std::unique_ptr<LatencyRecorder>> recorders;
+};
@@ -0,0 +1,388 @@
+#include "Scenario.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using json = nlohmann::json;
+
+namespace {
+    constexpr const char* op_names[] = { "public_message", "join_leave", "history", "private_message", "rename", "typing" };
+
+    OperationMix parseMix(const json& j) {
+        OperationMix mix;
+        mix.publicMessageRate = j.value("public_message", 0.0);
+        mix.joinLeaveRate = j.value("join_leave", 0.0);
+        mix.historyRate = j.value("history", 0.0);
+        mix.privateMessageRate = j.value("private_message", 0.0);
+        mix.renameRate = j.value("rename", 0.0);
+        mix.typingRate = j.value("typing", 0.0);
+        mix.historyBurst = std::max(1, j.value("history_burst", 1));
+        mix.historyLimit = j.value("history_limit", 50);
+        mix.privateBurst = std::max(1, j.value("private_burst", 1));
+        mix.messageBytes = j.value("message_bytes", static_cast<size_t>(32));
+        return mix;
+    }
+    uint64_t splitmix64(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+}
+
+Scenario Scenario::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open scenario file '" + path + "'");
+    }
+    Scenario scenario;
+    try {
+        const json j = json::parse(in);
+        scenario.seed = j.value("seed", static_cast<uint64_t>(1));
+        scenario.durationSeconds = j.value("duration_seconds", 60);
+        scenario.connectsPerSecond = j.value("connects_per_second", 100);
+        for (const auto& g : j.at("room_groups")) {
+            RoomGroup group;
+            group.name = g.at("name").get<std::string>();
+            group.prefix = g.value("prefix", group.name + "_");
+            group.count = std::max(1, g.value("count", 1));
+            group.distribution = g.value("distribution", "uniform");
+            group.skew = g.value("skew", 1.0);
+            scenario.roomGroups.push_back(std::move(group));
+        }
+        for (const auto& p : j.at("populations")) {
+            Population population;
+            population.name = p.at("name").get<std::string>();
+            population.clients = p.at("clients").get<int>();
+            population.roomGroup = p.at("room_group").get<std::string>();
+            population.mix = parseMix(p.value("operations", json::object()));
+            scenario.populations.push_back(std::move(population));
+        }
+    }
+    catch (const json::exception& e) {
+        throw std::runtime_error("Invalid scenario '" + path + "': " + e.what());
+    }
+    for (const auto& population : scenario.populations) {
+        scenario.findGroup(population.roomGroup);
+    }
+    return scenario;
+}
+const RoomGroup& Scenario::findGroup(const std::string& name) const {
+    for (const auto& group : roomGroups) {
+        if (group.name == name) {
+            return group;
+        }
+    }
+    throw std::runtime_error("Unknown room group '" + name + "'");
+}
+
+ScenarioRunner::ScenarioRunner(Scenario s, LatencyRecorder& latency) : scenario(std::move(s)), latency(latency) {
+    for (const auto& group : scenario.roomGroups) {
+        std::vector<double> cdf(group.count);
+        double total = 0;
+        for (int k = 0; k < group.count; ++k) {
+            total += group.distribution == "zipf" ? 1.0 / std::pow(k + 1, group.skew) : 1.0;
+            cdf[k] = total;
+        }
+        for (double& value : cdf) {
+            value /= total;
+        }
+        roomCdfs.push_back(std::move(cdf));
+    }
+}
+ScenarioRunner::~ScenarioRunner() = default;
+
+std::mt19937_64 ScenarioRunner::makeRng(uint64_t seed, uint64_t stream) {
+    return std::mt19937_64(splitmix64(seed ^ splitmix64(stream)));
+}
+std::string ScenarioRunner::pickRoom(const RoomGroup& group, std::mt19937_64& rng) const {
+    const size_t index = &group - scenario.roomGroups.data();
+    const auto& cdf = roomCdfs[index];
+    const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    const size_t room = std::min<size_t>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin(), cdf.size() - 1);
+    return group.prefix + std::to_string(room);
+}
+std::string ScenarioRunner::pickPrivateTarget(size_t populationIndex, std::mt19937_64& rng) const {
+    const auto& clients = clientsByPopulation[populationIndex];
+    return clients[std::uniform_int_distribution<size_t>(0, clients.size() - 1)(rng)]->getUsername();
+}
+void ScenarioRunner::onBroadcast(int64_t sentAtUs) {
+    broadcasts.fetch_add(1, std::memory_order_relaxed);
+    if (sentAtUs != 0) {
+        latency.record(LatencyRecorder::nowUs() - sentAtUs);
+    }
+}
+void ScenarioRunner::onEphemeral(int64_t sentAtUs) {
+    ephemerals.fetch_add(1, std::memory_order_relaxed);
+    if (sentAtUs != 0) {
+        ephemeralLatency.record(LatencyRecorder::nowUs() - sentAtUs);
+    }
+}
+void ScenarioRunner::run(std::vector<asio::io_context*> ioContexts, const std::string& host, unsigned short port) {
+    size_t total = 0;
+    uint64_t clientIndex = 0;
+    for (size_t p = 0; p < scenario.populations.size(); ++p) {
+        const Population& population = scenario.populations[p];
+        clientsByPopulation.emplace_back();
+        for (int i = 0; i < population.clients; ++i, ++clientIndex) {
+            const std::string username = "sc" + std::to_string(scenario.seed) + "_" + population.name + "_" + std::to_string(i);
+            auto client = std::make_shared<ScenarioClient>(*ioContexts[clientIndex % ioContexts.size()], *this, p, username,
+                splitmix64(scenario.seed + clientIndex));
+            clientsByPopulation.back().push_back(client);
+        }
+        total += population.clients;
+    }
+    // 按 connects_per_second 匀速建立连接
+    const auto connectInterval = std::chrono::microseconds(1000000 / std::max(1, scenario.connectsPerSecond));
+    auto nextConnect = std::chrono::steady_clock::now();
+    for (const auto& population : clientsByPopulation) {
+        for (const auto& client : population) {
+            client->connect(host, port, [client](const asio::error_code& ec) {
+                if (!ec) {
+                    client->begin();
+                }
+            });
+            nextConnect += connectInterval;
+            std::this_thread::sleep_until(nextConnect);
+        }
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::seconds(scenario.durationSeconds);
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        std::cout << "Ready: " << readyClients << "/" << total
+            << ", Messages: " << opCounts[static_cast<size_t>(ScenarioOp::PublicMessage)]
+            << ", Broadcasts: " << broadcasts << std::endl;
+    }
+    elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& population : clientsByPopulation) {
+        for (const auto& client : population) {
+            client->stop();
+        }
+    }
+}
+void ScenarioRunner::printSummary(std::ostream& out) const {
+    const double seconds = elapsedSeconds > 0 ? elapsedSeconds : 1.0;
+    out << "--- Scenario Summary (seed " << scenario.seed << ") ---\n";
+    for (size_t i = 0; i < opCounts.size(); ++i) {
+        out << std::left << std::setw(18) << op_names[i] << std::right << opCounts[i]
+            << " (" << opCounts[i] / seconds << "/s)\n";
+    }
+    out << std::left << std::setw(18) << "broadcasts" << std::right << broadcasts << " (" << broadcasts / seconds << "/s)\n";
+    if (ephemerals > 0) {
+        const LatencyRecorder::Summary latency = ephemeralLatency.summarize();
+        out << std::left << std::setw(18) << "ephemeral_recv" << std::right << ephemerals << " (" << ephemerals / seconds << "/s)"
+            << " p50=" << latency.p50 << "us p99=" << latency.p99 << "us max=" << latency.max << "us\n";
+    }
+    out << "-----------------------\n";
+}
+
+ScenarioClient::ScenarioClient(asio::io_context& ioc, ScenarioRunner& runner, size_t populationIndex, const std::string& username, uint64_t seed)
+    : Client(ioc),
+      runner(runner),
+      population(runner.getScenario().populations[populationIndex]),
+      group(runner.getScenario().findGroup(population.roomGroup)),
+      populationIndex(populationIndex),
+      username(username) {
+    // 最后多出的一个随机数流专用于初始房间分配
+    for (size_t op = 0; op <= static_cast<size_t>(ScenarioOp::Count); ++op) {
+        rngs.push_back(ScenarioRunner::makeRng(seed, op));
+    }
+    for (size_t op = 0; op < static_cast<size_t>(ScenarioOp::Count); ++op) {
+        timers.push_back(std::make_unique<asio::steady_timer>(ioc));
+    }
+}
+std::string ScenarioClient::getUsername() const {
+    std::lock_guard<std::mutex> lock(nameMutex);
+    return username;
+}
+void ScenarioClient::begin() {
+    Envelope envelope;
+    auto* req = envelope.mutable_registration_request();
+    req->set_username(getUsername());
+    req->set_password(password);
+    send(envelope);
+}
+void ScenarioClient::login() {
+    Envelope envelope;
+    auto* req = envelope.mutable_login_request();
+    req->set_username(getUsername());
+    req->set_password(password);
+    send(envelope);
+}
+void ScenarioClient::stop() {
+    stopped = true;
+    auto self = shared_from_this();
+    asio::post(timers.front()->get_executor(), [this, self]() {
+        for (auto& timer : timers) {
+            timer->cancel();
+        }
+        close();
+    });
+}
+void ScenarioClient::handle_server_message(const Envelope& envelope) {
+    switch (envelope.payload_case()) {
+        case Envelope::kRegistrationResponse:
+            // 同一种子重复运行时账号已存在，直接登录
+            login();
+            break;
+        case Envelope::kLoginResponse:
+            if (envelope.login_response().success()) {
+                room = runner.pickRoom(group, rngs.back());
+                sendRoomOperation(chat::RoomOperation::JOIN, room);
+            }
+            break;
+        case Envelope::kRoomOperationResponse: {
+            if (pendingRoomOps.empty()) {
+                break;
+            }
+            const chat::RoomOperation operation = pendingRoomOps.front();
+            pendingRoomOps.pop_front();
+            if (!envelope.room_operation_response().success()) {
+                onRoomOperationFailed(operation);
+                break;
+            }
+            if (operation == chat::RoomOperation::LEAVE) {
+                break;
+            }
+            roomRetries = 0;
+            if (!ready) {
+                ready = true;
+                runner.onReady();
+                for (size_t op = 0; op < static_cast<size_t>(ScenarioOp::Count); ++op) {
+                    schedule(static_cast<ScenarioOp>(op));
+                }
+            }
+            break;
+        }
+        case Envelope::kChangeUsernameResponse:
+            if (envelope.change_username_response().success()) {
+                std::lock_guard<std::mutex> lock(nameMutex);
+                username = envelope.change_username_response().new_username();
+            }
+            break;
+        case Envelope::kMessageBroadcast:
+            runner.onBroadcast(envelope.message_broadcast().client_timestamp_us());
+            break;
+        case Envelope::kEphemeralSignal:
+            runner.onEphemeral(envelope.ephemeral_signal().client_timestamp_us());
+            break;
+        case Envelope::kCompressionAccept:
+        case Envelope::kPing:
+            Client::handle_server_message(envelope);
+            break;
+        default:
+            break;
+    }
+}
+void ScenarioClient::sendRoomOperation(chat::RoomOperation operation, const std::string& roomName) {
+    Envelope envelope;
+    envelope.mutable_room_operation_request()->set_operation(operation);
+    envelope.mutable_room_operation_request()->set_room_name(roomName);
+    pendingRoomOps.push_back(operation);
+    send(envelope);
+}
+// 场景房间不预先创建：加入失败说明房间还不存在，由先到的客户端创建（创建者自动加入）；
+// 创建失败说明被其它客户端抢先创建，再加入一次
+void ScenarioClient::onRoomOperationFailed(chat::RoomOperation operation) {
+    constexpr int max_room_retries = 4;
+    // 后面还有排队的操作（换房间时的 LEAVE + JOIN）时，当前失败的请求已经过时
+    if (!pendingRoomOps.empty() || ++roomRetries > max_room_retries) {
+        return;
+    }
+    if (operation == chat::RoomOperation::JOIN) {
+        sendRoomOperation(chat::RoomOperation::CREATE, room);
+    } else if (operation == chat::RoomOperation::CREATE) {
+        sendRoomOperation(chat::RoomOperation::JOIN, room);
+    }
+}
+double ScenarioClient::rateOf(ScenarioOp op) const {
+    const OperationMix& mix = population.mix;
+    switch (op) {
+        case ScenarioOp::PublicMessage: return mix.publicMessageRate;
+        case ScenarioOp::JoinLeave: return mix.joinLeaveRate;
+        case ScenarioOp::History: return mix.historyRate;
+        case ScenarioOp::PrivateMessage: return mix.privateMessageRate;
+        case ScenarioOp::Rename: return mix.renameRate;
+        case ScenarioOp::Typing: return mix.typingRate;
+        default: return 0;
+    }
+}
+void ScenarioClient::schedule(ScenarioOp op) {
+    const double rate = rateOf(op);
+    if (rate <= 0 || stopped) {
+        return;
+    }
+    const size_t index = static_cast<size_t>(op);
+    const double delaySeconds = std::exponential_distribution<double>(rate)(rngs[index]);
+    timers[index]->expires_after(std::chrono::microseconds(static_cast<int64_t>(delaySeconds * 1e6)));
+    auto self = std::static_pointer_cast<ScenarioClient>(shared_from_this());
+    timers[index]->async_wait([this, self, op](const asio::error_code& ec) {
+        if (ec || stopped) {
+            return;
+        }
+        perform(op);
+        schedule(op);
+    });
+}
+void ScenarioClient::perform(ScenarioOp op) {
+    const OperationMix& mix = population.mix;
+    auto& rng = rngs[static_cast<size_t>(op)];
+    runner.countOp(op);
+    switch (op) {
+        case ScenarioOp::PublicMessage: {
+            Envelope envelope;
+            envelope.mutable_public_message()->set_content(std::string(mix.messageBytes, 'x'));
+            envelope.mutable_public_message()->set_client_timestamp_us(LatencyRecorder::nowUs());
+            send(envelope);
+            break;
+        }
+        case ScenarioOp::JoinLeave: {
+            sendRoomOperation(chat::RoomOperation::LEAVE, room);
+            room = runner.pickRoom(group, rng);
+            roomRetries = 0;
+            sendRoomOperation(chat::RoomOperation::JOIN, room);
+            break;
+        }
+        case ScenarioOp::History: {
+            for (int i = 0; i < mix.historyBurst; ++i) {
+                Envelope envelope;
+                envelope.mutable_history_message_request()->set_room_name(room);
+                envelope.mutable_history_message_request()->set_limit(mix.historyLimit);
+                send(envelope);
+            }
+            break;
+        }
+        case ScenarioOp::PrivateMessage: {
+            for (int i = 0; i < mix.privateBurst; ++i) {
+                Envelope envelope;
+                envelope.mutable_private_message_request()->set_to_username(runner.pickPrivateTarget(populationIndex, rng));
+                envelope.mutable_private_message_request()->set_content(std::string(mix.messageBytes, 'p'));
+                send(envelope);
+            }
+            break;
+        }
+        case ScenarioOp::Rename: {
+            Envelope envelope;
+            envelope.mutable_change_username_request()->set_new_username(
+                "sc" + std::to_string(runner.getScenario().seed) + "_" + population.name + "_r" + std::to_string(rng() % 1000000000) + "_" + std::to_string(++renames));
+            send(envelope);
+            break;
+        }
+        case ScenarioOp::Typing: {
+            Envelope envelope;
+            envelope.mutable_ephemeral_signal()->set_kind(chat::EphemeralKind::TYPING);
+            envelope.mutable_ephemeral_signal()->set_room_name(room);
+            envelope.mutable_ephemeral_signal()->set_client_timestamp_us(LatencyRecorder::nowUs());
+            send(envelope);
+            break;
+        }
+        default:
+            break;
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "client.h"
+#include "LatencyRecorder.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+// 一组房间及其人数分布：uniform 均匀分布，zipf 按 1/(k+1)^skew 分布（少数大房间 + 大量小房间）
+struct RoomGroup {
+    std::string name;
+    std::string prefix;
+    int count = 1;
+    std::string distribution = "uniform";
+    double skew = 1.0;
+};
+
+// 每个客户端每秒各类操作的期望次数，操作间隔服从指数分布
+struct OperationMix {
+    double publicMessageRate = 0;
+    double joinLeaveRate = 0;
+    double historyRate = 0;
+    double privateMessageRate = 0;
+    double renameRate = 0;
+    double typingRate = 0;     // 短暂信号（输入中），服务器按发送者限频后扇出，不落库
+    int historyBurst = 1;      // 一次历史拉取连续发出的请求数（模拟重连后的拉取风暴）
+    int historyLimit = 50;
+    int privateBurst = 1;      // 一次私聊连续发出的消息数
+    size_t messageBytes = 32;
+};
+
+struct Population {
+    std::string name;
+    int clients = 0;
+    std::string roomGroup;
+    OperationMix mix;
+};
+
+// 声明式压测场景，格式与 config.json 一样是 JSON，见 README
+struct Scenario {
+    uint64_t seed = 1;
+    int durationSeconds = 60;
+    int connectsPerSecond = 100;
+    std::vector<RoomGroup> roomGroups;
+    std::vector<Population> populations;
+
+    static Scenario load(const std::string& path); // 格式错误时抛出 std::runtime_error
+    const RoomGroup& findGroup(const std::string& name) const;
+};
+
+enum class ScenarioOp { PublicMessage, JoinLeave, History, PrivateMessage, Rename, Typing, Count };
+
+class ScenarioClient;
+
+// 按场景创建客户端并执行。每个客户端的操作序列由 (seed, 客户端序号) 决定，
+// 同一个种子重复运行得到相同的操作序列与房间分配。每个客户端固定在一个 io_context 上，
+// 该 io_context 只由一个线程运行，因此客户端内部状态无需加锁。
+class ScenarioRunner {
+public:
+    ScenarioRunner(Scenario scenario, LatencyRecorder& latency);
+    ~ScenarioRunner();
+
+    // 阻塞执行整个场景；客户端分布在 ioContexts 上
+    void run(std::vector<asio::io_context*> ioContexts, const std::string& host, unsigned short port);
+    void printSummary(std::ostream& out) const;
+
+    // 供客户端回调
+    void countOp(ScenarioOp op) { opCounts[static_cast<size_t>(op)].fetch_add(1, std::memory_order_relaxed); }
+    void onReady() { readyClients.fetch_add(1, std::memory_order_relaxed); }
+    void onBroadcast(int64_t sentAtUs);
+    // 短暂信号单独计数与记录延迟，与聊天消息的扇出开销分开统计
+    void onEphemeral(int64_t sentAtUs);
+    std::string pickPrivateTarget(size_t populationIndex, std::mt19937_64& rng) const;
+    static std::mt19937_64 makeRng(uint64_t seed, uint64_t stream);
+    std::string pickRoom(const RoomGroup& group, std::mt19937_64& rng) const;
+    const Scenario& getScenario() const { return scenario; }
+private:
+    Scenario scenario;
+    LatencyRecorder& latency;
+    std::vector<std::vector<double>> roomCdfs; // 与 scenario.roomGroups 一一对应
+    std::vector<std::vector<std::shared_ptr<ScenarioClient>>> clientsByPopulation;
+    std::array<std::atomic<long long>, static_cast<size_t>(ScenarioOp::Count)> opCounts{};
+    std::atomic<long long> broadcasts{0};
+    std::atomic<long long> ephemerals{0};
+    LatencyRecorder ephemeralLatency;
+    std::atomic<int> readyClients{0};
+    double elapsedSeconds = 0;
+};
+
+class ScenarioClient : public Client {
+public:
+    ScenarioClient(asio::io_context& ioc, ScenarioRunner& runner, size_t populationIndex, const std::string& username, uint64_t seed);
+
+    void begin();
+    std::string getUsername() const;
+    void stop();
+protected:
+    void handle_server_message(const Envelope& envelope) override;
+private:
+    void schedule(ScenarioOp op);
+    void perform(ScenarioOp op);
+    double rateOf(ScenarioOp op) const;
+    void login();
+    void sendRoomOperation(chat::RoomOperation operation, const std::string& roomName);
+    void onRoomOperationFailed(chat::RoomOperation operation);
+
+    ScenarioRunner& runner;
+    const Population& population;
+    const RoomGroup& group;
+    size_t populationIndex;
+    // 每类操作一个独立的随机数流，操作之间的交错不影响各自的序列
+    std::vector<std::mt19937_64> rngs;
+    std::vector<std::unique_ptr<asio::steady_timer>> timers;
+    mutable std::mutex nameMutex;
+    std::string username;
+    std::string password = "123456";
+    std::string room;
+    int renames = 0;
+    // 已发出、尚未收到响应的房间操作。响应按请求顺序返回，且失败响应不一定带 operation 字段
+    std::deque<chat::RoomOperation> pendingRoomOps;
+    int roomRetries = 0;   // 加入/创建当前房间连续失败的次数
+    bool ready = false;
+    std::atomic<bool> stopped{false};
+};
@@ -1,16 +1,40 @@
 #include "client.h" 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <thread>
 #include <atomic>
 #include <chrono>
 #include <random>
+#include <mutex>
+#include <fstream>
+#include <ctime>
+#include <cstring>
+#include "codec/FrameCodec.h"
+#include "LatencyRecorder.h"
+#include "OpenLoopDriver.h"
+#include "Scenario.h"
+#include "LeanClient.h"
 
 
 std::atomic<int> connected_clients = 0;
 std::atomic<int> successful_logins = 0;
 std::atomic<long long> messages_sent = 0;
 std::atomic<long long> messages_received = 0;
+std::atomic<long long> broadcasts_received = 0;
+std::atomic<int> joined_clients = 0;
+
+// 收到的消息体样本，用于离线训练 zstd 字典。训练只需几 MB 样本，攒满上限后不再记录
+constexpr size_t max_sample_bytes = 8 * 1024 * 1024;
+std::mutex samples_mutex;
+std::vector<std::string> recorded_samples;
+size_t recorded_sample_bytes = 0;
+bool record_samples = false;
+std::atomic<bool> samples_full = false;
+
+// 广播到达各接收端的端到端延迟；开环模式下改由 open_loop 按步骤记录
+LatencyRecorder fanout_latency;
+OpenLoopDriver* open_loop = nullptr;
 
 class TestClient : public Client {
 public:
@@ -42,11 +66,34 @@ public:
 
         schedule_send();
     }
+    void send_public(int64_t stamp_us) {
+        Envelope public_envelope;
+        std::string content = "Automatic message, time is " + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+        public_envelope.mutable_public_message()->set_content(content);
+        public_envelope.mutable_public_message()->set_client_timestamp_us(stamp_us);
+        send(public_envelope);
+        messages_sent++;
+    }
+    bool has_joined() const { return joined.load(std::memory_order_acquire); }
 
 protected:
     void handle_server_message(const Envelope& envelope) override {
-        Client::handle_server_message(envelope);
+        // 广播不交给基类打印，否则终端输出会主导测得的延迟
+        if (envelope.payload_case() != chat::Envelope::kMessageBroadcast) {
+            Client::handle_server_message(envelope);
+        }
         ++messages_received;
+        if (record_samples && !samples_full.load(std::memory_order_relaxed)) {
+            std::string body;
+            envelope.SerializeToString(&body);
+            std::lock_guard<std::mutex> lock(samples_mutex);
+            if (recorded_sample_bytes + body.size() > max_sample_bytes) {
+                samples_full.store(true, std::memory_order_relaxed);
+            } else {
+                recorded_sample_bytes += body.size();
+                recorded_samples.push_back(std::move(body));
+            }
+        }
         switch(envelope.payload_case()) {
             case chat::Envelope::kRegistrationResponse: {
                 const auto& reg_resp = envelope.registration_response();
@@ -61,6 +108,33 @@ protected:
                 if (login_resp.success()) {
                     std::cout << "logged in success" << std::endl;
                     successful_logins++;
+                    // 登录成功后才能加入房间，加入成功后才开始发消息
+                    Envelope join_envelope;
+                    join_envelope.mutable_room_operation_request()->set_operation(chat::RoomOperation::JOIN);
+                    join_envelope.mutable_room_operation_request()->set_room_name("room1");
+                    send(join_envelope);
+                }
+                break;
+            }
+            case chat::Envelope::kRoomOperationResponse: {
+                if (envelope.room_operation_response().success() && !joined.exchange(true)) {
+                    ++joined_clients;
+                    if (!open_loop) {
+                        start_sending();
+                    }
+                }
+                break;
+            }
+            case chat::Envelope::kMessageBroadcast: {
+                ++broadcasts_received;
+                const int64_t sent_at = envelope.message_broadcast().client_timestamp_us();
+                if (sent_at != 0) {
+                    if (open_loop) {
+                        open_loop->recordDelivery(sent_at, LatencyRecorder::nowUs());
+                    }
+                    else {
+                        fanout_latency.record(LatencyRecorder::nowUs() - sent_at);
+                    }
                 }
                 break;
             }
@@ -80,19 +154,14 @@ private:
         m_timer.async_wait([this, self](const asio::error_code& ec) {
             if (ec) { return; } 
 
-            Envelope public_envelope;
-            std::string content = "Automatic message, time is " + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
-            public_envelope.mutable_public_message()->set_content(content);
-
-            send(public_envelope);
-            messages_sent++;
-
+            send_public(LatencyRecorder::nowUs());
             schedule_send();
             });
     }
 
     std::mt19937 m_rng{ std::random_device{}() };
     asio::steady_timer m_timer;
+    std::atomic<bool> joined{false};
 };
 
 
@@ -136,10 +205,10 @@ private:
 //                }
 //                });
 //
-//            // ˲ȫ
+//            // 避免瞬间全连上
 //            std::this_thread::sleep_for(std::chrono::milliseconds(5));
 //        }
-//        // ȴӽ
+//        // 等待所有连接建立
 //        std::this_thread::sleep_for(std::chrono::seconds(10));
 //        std::cout << "Total connections established: " << connected_clients << std::endl;
 //
@@ -161,19 +230,284 @@ private:
 //    return 0;
 //}
 
+// 样本文件格式与网络帧相同：4 字节长度 + 消息体
+bool write_samples(const std::string& path, const std::vector<std::string>& samples) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        return false;
+    }
+    for (const auto& sample : samples) {
+        char header[FrameCodec::header_length];
+        FrameCodec::writeHeader(header, static_cast<uint32_t>(sample.size()), false);
+        out.write(header, sizeof(header));
+        out.write(sample.data(), sample.size());
+    }
+    return true;
+}
+void save_recorded_samples(const std::string& path) {
+    std::lock_guard<std::mutex> lock(samples_mutex);
+    if (write_samples(path, recorded_samples)) {
+        std::cout << "Recorded " << recorded_samples.size() << " samples (" << recorded_sample_bytes << " bytes"
+            << (samples_full ? ", limit reached" : "") << ") to " << path << "\n";
+    } else {
+        std::cerr << "Failed to write samples to " << path << "\n";
+    }
+}
+bool read_samples(const std::string& path, std::vector<std::string>& samples) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::array<char, FrameCodec::header_length> header;
+    while (in.read(header.data(), header.size())) {
+        bool compressed = false;
+        std::string body(FrameCodec::readHeader(header, compressed), '\0');
+        if (!in.read(body.data(), body.size())) {
+            break;
+        }
+        samples.push_back(std::move(body));
+    }
+    return true;
+}
+int train_dictionary(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: tester --train-dict <output> <samples>...\n";
+        return 1;
+    }
+    std::vector<std::string> samples;
+    for (int i = 3; i < argc; ++i) {
+        if (!read_samples(argv[i], samples)) {
+            std::cerr << "Failed to read samples from " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    std::string dictionary = ZstdCompressor::trainDictionary(samples);
+    if (dictionary.empty()) {
+        return 1;
+    }
+    std::ofstream out(argv[2], std::ios::binary);
+    out.write(dictionary.data(), dictionary.size());
+    ZstdCompressor check;
+    check.setDictionary(dictionary);
+    std::cout << "Trained dictionary from " << samples.size() << " samples: " << dictionary.size()
+        << " bytes, ID " << check.getDictionaryId() << "\n";
+    return 0;
+}
+void print_traffic_summary(const std::vector<std::shared_ptr<TestClient>>& clients, std::clock_t cpu_start) {
+    Client::TrafficStats total;
+    for (const auto& client : clients) {
+        Client::TrafficStats stats = client->getTrafficStats();
+        total.frames_received += stats.frames_received;
+        total.wire_bytes_received += stats.wire_bytes_received;
+        total.decoded_bytes_received += stats.decoded_bytes_received;
+        total.decompress_ns += stats.decompress_ns;
+        total.wire_bytes_sent += stats.wire_bytes_sent;
+    }
+    const double frames = total.frames_received ? static_cast<double>(total.frames_received) : 1.0;
+    const double cpu_us = 1e6 * static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    std::cout << "--- Traffic Summary ---\n"
+        << "Frames Received: " << total.frames_received << "\n"
+        << "Wire Bytes Received: " << total.wire_bytes_received
+        << " (" << total.wire_bytes_received / frames << " B/msg)\n"
+        << "Decoded Bytes Received: " << total.decoded_bytes_received
+        << " (" << total.decoded_bytes_received / frames << " B/msg)\n"
+        << "Compression Ratio: "
+        << (total.wire_bytes_received ? static_cast<double>(total.decoded_bytes_received) / total.wire_bytes_received : 0.0) << "\n"
+        << "Wire Bytes Sent: " << total.wire_bytes_sent << "\n"
+        << "Decompression CPU: " << total.decompress_ns / frames / 1000.0 << " us/msg\n"
+        << "Process CPU: " << cpu_us / frames << " us/msg\n"
+        << "-----------------------\n";
+}
+
+int run_scenario(int argc, char* argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: tester --scenario <file> <host> <port> [threads] [--json <report>]\n";
+        return 1;
+    }
+    Scenario scenario;
+    try {
+        scenario = Scenario::load(argv[2]);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    const std::string host = argv[3];
+    const unsigned short port = std::stoi(argv[4]);
+    int num_threads = (argc > 5 && argv[5][0] != '-') ? std::stoi(argv[5]) : std::thread::hardware_concurrency();
+    num_threads = num_threads > 0 ? num_threads : 1;
+    std::string report_path;
+    for (int i = 5; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            report_path = argv[i + 1];
+        }
+    }
+    // 每个线程一个 io_context，客户端固定在其中一个上，回调天然串行
+    std::vector<std::unique_ptr<asio::io_context>> contexts;
+    std::vector<asio::executor_work_guard<asio::io_context::executor_type>> guards;
+    std::vector<asio::io_context*> context_ptrs;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        contexts.push_back(std::make_unique<asio::io_context>(1));
+        guards.push_back(asio::make_work_guard(*contexts.back()));
+        context_ptrs.push_back(contexts.back().get());
+    }
+    for (auto& context : contexts) {
+        threads.emplace_back([ioc = context.get()]() { ioc->run(); });
+    }
+    std::cout << "Running scenario " << argv[2] << " (seed " << scenario.seed << ") on " << num_threads << " threads...\n";
+    ScenarioRunner runner(scenario, fanout_latency);
+    runner.run(context_ptrs, host, port);
+    runner.printSummary(std::cout);
+    LatencyReport report;
+    report.label = std::string("scenario:") + argv[2];
+    report.durationSeconds = scenario.durationSeconds;
+    report.latency = fanout_latency.summarize();
+    report.messagesReceived = report.latency.count;
+    report.printText(std::cout);
+    if (!report_path.empty() && !writeReportsJson(report_path, { report })) {
+        std::cerr << "Failed to write report to " << report_path << "\n";
+    }
+    guards.clear();
+    for (auto& t : threads) {
+        t.join();
+    }
+    return 0;
+}
+
+int run_lean(int argc, char* argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: tester --lean <host> <port> <connections> [threads] [--source-ips <ip,ip,...>] [--connect-rate <n/s>]\n"
+            << "              [--hold-seconds <s>] [--room <name>] [--user-prefix <prefix>] [--metrics <host:port>]\n";
+        return 1;
+    }
+    LeanOptions options;
+    options.host = argv[2];
+    options.port = static_cast<unsigned short>(std::stoi(argv[3]));
+    options.connections = std::stoi(argv[4]);
+    options.threads = (argc > 5 && argv[5][0] != '-') ? std::stoi(argv[5]) : std::thread::hardware_concurrency();
+    try {
+        for (int i = 5; i + 1 < argc; ++i) {
+            if (std::strcmp(argv[i], "--source-ips") == 0) {
+                std::string list = argv[i + 1];
+                size_t start = 0;
+                while (start <= list.size()) {
+                    const size_t end = std::min(list.find(',', start), list.size());
+                    if (end > start) {
+                        options.sourceAddresses.push_back(asio::ip::make_address(list.substr(start, end - start)));
+                    }
+                    start = end + 1;
+                }
+            }
+            else if (std::strcmp(argv[i], "--connect-rate") == 0) {
+                options.connectRate = std::stod(argv[i + 1]);
+            }
+            else if (std::strcmp(argv[i], "--hold-seconds") == 0) {
+                options.holdSeconds = std::stoi(argv[i + 1]);
+            }
+            else if (std::strcmp(argv[i], "--room") == 0) {
+                options.room = argv[i + 1];
+            }
+            else if (std::strcmp(argv[i], "--user-prefix") == 0) {
+                options.userPrefix = argv[i + 1];
+            }
+            else if (std::strcmp(argv[i], "--metrics") == 0) {
+                options.metricsEndpoint = argv[i + 1];
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return 1;
+    }
+    return runLeanMode(options);
+}
+
 int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--train-dict") == 0) {
+        return train_dictionary(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--scenario") == 0) {
+        return run_scenario(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--lean") == 0) {
+        return run_lean(argc, argv);
+    }
     if (argc < 4) {
-        std::cerr << "Usage: chat_client <host> <port>\n";
+        std::cerr << "Usage: tester <host> <port> <num_clients> [threads] [--compress zstd|<dictionary>] [--record-samples <file>]\n"
+            << "              [--stall-readers <n>] [--json <report>]\n"
+            << "              [--rate <msg/s> [--ramp <steps>] | --sweep <start:end:step>] [--step-seconds <s>]\n"
+            << "       tester --scenario <file> <host> <port> [threads] [--json <report>]\n"
+            << "       tester --lean <host> <port> <connections> [threads] [--source-ips <ip,...>] [--connect-rate <n/s>] ...\n"
+            << "       tester --train-dict <output> <samples>...\n";
         return 1;
     }
 
     const std::string host = argv[1];
     const unsigned short port = std::stoi(argv[2]);
     const int num_clients = std::stoi(argv[3]);
-    int num_threads = (argc > 4) ? std::stoi(argv[4]) : std::thread::hardware_concurrency();
+    int num_threads = (argc > 4 && argv[4][0] != '-') ? std::stoi(argv[4]) : std::thread::hardware_concurrency();
+    std::shared_ptr<ZstdCompressor> compressor;
+    std::string samples_path;
+    int stalled_readers = 0;
+    std::string report_path;
+    double target_rate = 0;
+    int ramp_steps = 0;
+    std::string sweep_spec;
+    int step_seconds = 0;
+    for (int i = 4; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--compress") == 0) {
+            compressor = std::make_shared<ZstdCompressor>();
+            if (std::strcmp(argv[i + 1], "zstd") != 0 && !compressor->loadDictionary(argv[i + 1])) {
+                std::cerr << "Failed to load dictionary " << argv[i + 1] << "\n";
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--stall-readers") == 0) {
+            stalled_readers = std::stoi(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--rate") == 0) {
+            target_rate = std::stod(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--ramp") == 0) {
+            ramp_steps = std::stoi(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--sweep") == 0) {
+            sweep_spec = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--step-seconds") == 0) {
+            step_seconds = std::stoi(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--json") == 0) {
+            report_path = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--record-samples") == 0) {
+            samples_path = argv[i + 1];
+            record_samples = true;
+        }
+    }
 
-    std::cout << "Starting stress test with " << num_clients << " clients on "
-        << num_threads << " threads...\n";
+    // 开环模式：--sweep 逐步提高速率，--rate 单一速率（可配合 --ramp 分步升速）
+    std::unique_ptr<OpenLoopDriver> driver;
+    try {
+        if (!sweep_spec.empty()) {
+            driver = std::make_unique<OpenLoopDriver>(OpenLoopDriver::parseSweep(sweep_spec),
+                std::chrono::seconds(step_seconds > 0 ? step_seconds : 10));
+        }
+        else if (target_rate > 0) {
+            const int steps = ramp_steps > 0 ? ramp_steps : 1;
+            // 未指定每步时长时总共升速一分钟；按毫秒计算，步数超过 60 时每步不会变成 0
+            const std::chrono::milliseconds step_duration = step_seconds > 0
+                ? std::chrono::milliseconds(std::chrono::seconds(step_seconds))
+                : std::chrono::milliseconds(std::max(1, 60000 / steps));
+            driver = std::make_unique<OpenLoopDriver>(OpenLoopDriver::rampTo(target_rate, steps), step_duration);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    open_loop = driver.get();
 
     asio::io_context io_context;
 
@@ -189,6 +523,9 @@ int main(int argc, char* argv[]) {
     std::vector<std::shared_ptr<TestClient>> clients;
     for (int i = 0; i < num_clients; ++i) {
         auto client = std::make_shared<TestClient>(io_context);
+        if (compressor) {
+            client->enableCompression(compressor);
+        }
         clients.push_back(client);
 
         client->connect(host, port, [client](const asio::error_code& ec) {
@@ -199,14 +536,64 @@ int main(int argc, char* argv[]) {
 
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
-    for(const auto& client : clients) {
-        chat::Envelope join_envelope;
-        join_envelope.mutable_room_operation_request()->set_operation(chat::RoomOperation::JOIN);
-        join_envelope.mutable_room_operation_request()->set_room_name("room1");
-        client->send(join_envelope);
-        client->start_sending();
-	}
+    // 前 n 个客户端停止读取，服务器端出站队列应被限额约束，内存保持平稳
+    for (int i = 0; i < stalled_readers && i < static_cast<int>(clients.size()); ++i) {
+        clients[i]->pauseReading();
+    }
+    if (open_loop) {
+        // 等所有客户端加入房间后再开始按计划发送
+        const auto join_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (joined_clients < num_clients && std::chrono::steady_clock::now() < join_deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        std::vector<std::shared_ptr<TestClient>> senders;
+        for (const auto& client : clients) {
+            if (client->has_joined()) {
+                senders.push_back(client);
+            }
+        }
+        if (senders.empty()) {
+            std::cerr << "No client joined the room, aborting.\n";
+            for (const auto& client : clients) {
+                client->close();
+            }
+            work_guard.reset();
+            io_context.stop();
+            for (auto& t : threads) {
+                t.join();
+            }
+            return 1;
+        }
+        std::cout << senders.size() << " clients joined. Running open-loop load...\n";
+        const std::clock_t cpu_start = std::clock();
+        open_loop->run([&senders](uint64_t sequence, int64_t intended_us) {
+            senders[sequence % senders.size()]->send_public(intended_us);
+        });
+        print_traffic_summary(clients, cpu_start);
+        const std::vector<LatencyReport> reports = open_loop->getReports();
+        for (const auto& report : reports) {
+            report.printText(std::cout);
+        }
+        OpenLoopDriver::printCurve(std::cout, reports);
+        if (!report_path.empty() && !writeReportsJson(report_path, reports)) {
+            std::cerr << "Failed to write report to " << report_path << "\n";
+        }
+        if (record_samples) {
+            save_recorded_samples(samples_path);
+        }
+        for (const auto& client : clients) {
+            client->close();
+        }
+        work_guard.reset();
+        for (auto& t : threads) {
+            t.join();
+        }
+        return 0;
+    }
     std::cout << "All clients initiated. Running test for 60 seconds...\n";
+    const std::clock_t cpu_start = std::clock();
+    const long long sent_before = messages_sent;
+    const long long received_before = broadcasts_received;
     auto start_time = std::chrono::steady_clock::now();
    while(std::chrono::steady_clock::now() - start_time < std::chrono::seconds(60)){
         std::cout << "Connected: " << connected_clients
@@ -220,6 +607,20 @@ int main(int argc, char* argv[]) {
         << "Total Logins: " << successful_logins << "\n"
         << "Total Messages: " << messages_sent << "\n"
         << "---------------------\n";
+    print_traffic_summary(clients, cpu_start);
+    LatencyReport report;
+    report.label = "closed_loop";
+    report.durationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    report.messagesSent = messages_sent - sent_before;
+    report.messagesReceived = broadcasts_received - received_before;
+    report.latency = fanout_latency.summarize();
+    report.printText(std::cout);
+    if (!report_path.empty() && !writeReportsJson(report_path, { report })) {
+        std::cerr << "Failed to write report to " << report_path << "\n";
+    }
+    if (record_samples) {
+        save_recorded_samples(samples_path);
+    }
 
     std::cout << "Test finished. Closing all connections...\n";
     for (const auto& client : clients) {